@@ -0,0 +1,95 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace bench
+{
+
+/** hardware counter of the calling thread, based on perf_event_open
+ *
+ * The counter is not available in many containers / VMs, read() returns nullopt then.
+ */
+class perf_counter
+{
+   public:
+    explicit perf_counter(std::uint64_t config = PERF_COUNT_HW_CACHE_MISSES)
+    {
+        auto attr           = perf_event_attr{};
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.size           = sizeof(attr);
+        attr.config         = config;
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    perf_counter(const perf_counter& other) = delete;
+    auto operator=(const perf_counter& rhs) -> perf_counter& = delete;
+
+    perf_counter(perf_counter&& rhs) noexcept = delete;
+    auto operator=(perf_counter&& rhs) noexcept -> perf_counter& = delete;
+
+    ~perf_counter()
+    {
+        if (fd >= 0) close(fd);
+    }
+
+    auto start() -> void
+    {
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    auto stop() -> std::optional<std::uint64_t>
+    {
+        auto value = std::uint64_t{0};
+        if (fd < 0) return std::nullopt;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (::read(fd, &value, sizeof(value)) != sizeof(value)) return std::nullopt;
+        return value;
+    }
+
+   private:
+    int fd{-1};
+};
+
+/** elapsed wall clock and cpu time of the calling thread
+ */
+class stopwatch
+{
+   public:
+    using clock = std::chrono::steady_clock;
+
+    stopwatch() : wall{clock::now()}, cpu{thread_cpu_time()} {}
+
+    [[nodiscard]] auto elapsed() const -> std::chrono::nanoseconds { return clock::now() - wall; }
+    [[nodiscard]] auto cpu_elapsed() const -> std::chrono::nanoseconds { return thread_cpu_time() - cpu; }
+
+    static auto thread_cpu_time() -> std::chrono::nanoseconds
+    {
+        auto ts = timespec{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+    }
+
+   private:
+    clock::time_point        wall;
+    std::chrono::nanoseconds cpu;
+};
+
+}  // namespace bench
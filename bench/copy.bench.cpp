@@ -0,0 +1,121 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <array>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "io/copy_engine.hpp"
+#include "io/io.hpp"
+
+/**
+ * Copy a frame into a pool of frames (like io::get_data does) and re-read a
+ * hot working set in between (like the rest of the application does).
+ * Reports the copy bandwidth, the LLC misses per frame and how much slower the
+ * hot working set gets because the copy evicted it from the cache. The fused
+ * copy + CRC32C shows the cost of sealing a frame (--integrity).
+ */
+namespace
+{
+constexpr size_t frames     = 4;
+constexpr size_t iterations = 64;
+constexpr size_t hot_size   = 2 * 1024 * 1024;
+
+volatile long sink = 0;  // keeps the hot set reads alive
+
+auto run(const char* name, io::copy_config const& cfg, std::vector<std::unique_ptr<char[]>>& pool, const std::vector<char>& src,
+         std::vector<char>& hot, bool crc = false) -> void
+{
+    io::configure_copy(cfg);
+
+    auto copy_time = std::chrono::nanoseconds{0};
+    auto hot_time  = std::chrono::nanoseconds{0};
+    auto sum       = 0L;
+    auto counter   = bench::perf_counter{};
+
+    counter.start();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        auto copy = bench::stopwatch{};
+        if (crc)
+        {
+            sum += io::copy_memory_crc32c(pool[i % frames].get(), src.data(), src.size());
+        }
+        else
+        {
+            io::copy_memory(pool[i % frames].get(), src.data(), src.size());
+        }
+        copy_time += copy.elapsed();
+
+        auto reread = bench::stopwatch{};
+        for (size_t j = 0; j < hot.size(); j += 64)
+        {
+            sum += hot[j];
+        }
+        hot_time += reread.elapsed();
+    }
+    auto misses = counter.stop();
+
+    auto bytes = static_cast<double>(src.size() * iterations);
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(2)  //
+              << std::setw(10) << bytes / static_cast<double>(copy_time.count()) << " GB/s"                //
+              << std::setw(10) << static_cast<double>(hot_time.count()) / (iterations * hot.size() / 64.0) << " ns/line";
+    if (misses)
+    {
+        std::cout << std::setw(14) << *misses / iterations << " LLC misses/frame";
+    }
+    else
+    {
+        std::cout << std::setw(14) << "n/a" << " LLC misses/frame";
+    }
+    std::cout << "\n";
+    sink = sum;
+}
+}  // namespace
+
+auto main() -> int
+{
+    auto src = std::vector<char>(io::frame_size);
+    std::iota(src.begin(), src.end(), 0);
+    auto hot = std::vector<char>(hot_size, 1);
+
+    auto pool = std::vector<std::unique_ptr<char[]>>{};
+    for (size_t i = 0; i < frames; ++i)
+    {
+        pool.push_back(std::make_unique<char[]>(io::frame_size));  // zeroed, so all pages are faulted in
+    }
+
+    std::cout << "[bench] copy " << iterations << " frames of " << io::frame_size / (1024 * 1024) << " MiB, isa " << io::copy_isa()
+              << ", hot set " << hot_size / 1024 << " KiB\n";
+
+    auto cfg      = io::copy_config{};
+    cfg.streaming = false;
+    run("memcpy", cfg, pool, src, hot);
+
+    cfg.streaming = true;
+    cfg.threads   = 0;
+    run("streaming", cfg, pool, src, hot);
+    run("streaming+crc32c", cfg, pool, src, hot, true);
+
+    for (unsigned threads : {1U, 3U})
+    {
+        if (threads < std::thread::hardware_concurrency())
+        {
+            cfg.threads = threads;
+            auto name   = "streaming x" + std::to_string(threads + 1);
+            run(name.c_str(), cfg, pool, src, hot);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "utils/sharded_queue.hpp"
+#include "utils/wait_strategy.hpp"
+
+/**
+ * Hand over time stamped messages from a producer to a consumer through the
+ * sharded queue and measure the wake-up latency of the consumer and its cpu
+ * cost for every wait policy.
+ *
+ * usage: handoff_bench [spin budget in us, default 50]
+ */
+namespace
+{
+using clock = std::chrono::steady_clock;
+
+constexpr size_t messages = 1000;
+
+auto run(utils::wait_policy policy, std::chrono::microseconds interval, std::chrono::microseconds spin_budget) -> void
+{
+    auto q = utils::sharded_queue<clock::time_point>{1, 16, 1, utils::wait_strategy{policy, spin_budget}};
+
+    auto latencies = std::vector<clock::duration>{};
+    latencies.reserve(messages);
+    auto cpu  = std::chrono::nanoseconds{0};
+    auto wall = std::chrono::nanoseconds{0};
+
+    auto consumer = std::thread{[&]()
+                                {
+                                    auto watch = bench::stopwatch{};
+                                    for (size_t i = 0; i < messages; ++i)
+                                    {
+                                        auto stamp = q.dequeue(0);
+                                        latencies.push_back(clock::now() - *stamp);
+                                    }
+                                    cpu  = watch.cpu_elapsed();
+                                    wall = watch.elapsed();
+                                }};
+
+    for (size_t i = 0; i < messages; ++i)
+    {
+        std::this_thread::sleep_for(interval);
+        while (!q.enqueue(0, std::make_shared<clock::time_point>(clock::now())))
+        {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto us = [](clock::duration d) { return std::chrono::duration<double, std::micro>{d}.count(); };
+    std::cout << std::left << std::setw(12) << utils::to_string(policy) << std::right << std::fixed << std::setprecision(1)  //
+              << std::setw(8) << interval.count() << "us"                                                                 //
+              << std::setw(10) << us(latencies[messages / 2]) << "us"                                                      //
+              << std::setw(10) << us(latencies[messages * 99 / 100]) << "us"                                               //
+              << std::setw(10) << us(latencies.back()) << "us"                                                             //
+              << std::setw(9) << 100.0 * static_cast<double>(cpu.count()) / static_cast<double>(wall.count()) << "%\n";
+}
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+    auto spin_budget = std::chrono::microseconds{argc > 1 ? std::atoi(argv[1]) : 50};
+    if (spin_budget.count() < 0)
+    {
+        std::cerr << "usage: " << argv[0] << " [spin budget in us, default 50]\n";
+        return 1;
+    }
+
+    std::cout << "[bench] hand over " << messages << " messages per policy, spin budget " << spin_budget.count() << "us\n"
+              << std::left << std::setw(12) << "policy" << std::right << std::setw(10) << "interval" << std::setw(12) << "p50"
+              << std::setw(12) << "p99" << std::setw(12) << "max" << std::setw(10) << "cpu\n";
+
+    for (auto interval : {std::chrono::microseconds{20}, std::chrono::microseconds{1000}})
+    {
+        for (auto policy : {utils::wait_policy::block, utils::wait_policy::spin, utils::wait_policy::spin_yield, utils::wait_policy::spin_park})
+        {
+            run(policy, interval, spin_budget);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "io/checksum.hpp"
+
+#include <array>
+#include <cstring>
+
+#include "io/checksum_impl.hpp"
+
+namespace io
+{
+namespace
+{
+constexpr std::uint32_t polynomial = 0x82F63B78;  // reflected Castagnoli polynomial
+
+constexpr auto make_table()
+{
+    auto table = std::array<std::uint32_t, 256>{};
+    for (std::uint32_t i = 0; i < table.size(); ++i)
+    {
+        auto crc = i;
+        for (auto bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ polynomial : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr auto table = make_table();
+
+auto generic_update(std::uint32_t state, const char* data, size_t size) -> std::uint32_t
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        state = table[(state ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (state >> 8);
+    }
+    return state;
+}
+
+#ifdef IO_CRC_X86
+__attribute__((target("sse4.2"))) auto hw_crc32c(const char* data, size_t size, std::uint32_t crc) -> std::uint32_t
+{
+    // three independent dependency chains over three stripes keep the crc32 unit busy,
+    // a single chain is bound by the latency of the instruction
+    constexpr size_t min_stripe = 4096;
+    auto             stripe     = size / 3 / sizeof(std::uint64_t) * sizeof(std::uint64_t);
+    if (stripe < min_stripe)
+    {
+        return ~detail::crc32c_update_hw(~crc, data, size);
+    }
+
+    std::uint64_t a = ~crc, b = ~0U, c = ~0U;
+    for (size_t i = 0; i < stripe; i += sizeof(std::uint64_t))
+    {
+        a = detail::crc32c_u64(a, data + i);
+        b = detail::crc32c_u64(b, data + stripe + i);
+        c = detail::crc32c_u64(c, data + 2 * stripe + i);
+    }
+    crc = crc32c_combine(~static_cast<std::uint32_t>(a), ~static_cast<std::uint32_t>(b), stripe);
+    crc = crc32c_combine(crc, ~static_cast<std::uint32_t>(c), stripe);
+    return ~detail::crc32c_update_hw(~crc, data + 3 * stripe, size - 3 * stripe);
+}
+#endif
+
+using crc_fn = std::uint32_t (*)(const char* data, size_t size, std::uint32_t crc);
+
+auto generic_crc32c(const char* data, size_t size, std::uint32_t crc) -> std::uint32_t { return ~generic_update(~crc, data, size); }
+
+struct implementation
+{
+    implementation()
+    {
+#ifdef IO_CRC_X86
+        if (__builtin_cpu_supports("sse4.2"))
+        {
+            isa = "sse4.2";
+            fn  = hw_crc32c;
+        }
+#endif
+    }
+
+    const char* isa = "generic";
+    crc_fn      fn  = generic_crc32c;
+};
+
+auto the_implementation() -> const implementation&
+{
+    static const auto i = implementation{};
+    return i;
+}
+
+// GF(2) matrix helpers to append zeros to a crc, see zlib crc32_combine
+auto gf2_times(const std::array<std::uint32_t, 32>& mat, std::uint32_t vec) -> std::uint32_t
+{
+    auto sum = std::uint32_t{0};
+    for (auto row = mat.begin(); vec; vec >>= 1, ++row)
+    {
+        if (vec & 1)
+        {
+            sum ^= *row;
+        }
+    }
+    return sum;
+}
+
+auto gf2_square(const std::array<std::uint32_t, 32>& mat) -> std::array<std::uint32_t, 32>
+{
+    auto square = std::array<std::uint32_t, 32>{};
+    for (size_t n = 0; n < square.size(); ++n)
+    {
+        square[n] = gf2_times(mat, mat[n]);
+    }
+    return square;
+}
+
+}  // namespace
+
+auto crc32c(const void* data, size_t size, std::uint32_t crc) -> std::uint32_t  //
+{
+    return the_implementation().fn(static_cast<const char*>(data), size, crc);
+}
+
+auto crc32c_combine(std::uint32_t crc_a, std::uint32_t crc_b, size_t size_b) -> std::uint32_t
+{
+    if (size_b == 0)
+    {
+        return crc_a;
+    }
+
+    // operator for one zero bit, then for two and four zero bits
+    auto odd = std::array<std::uint32_t, 32>{polynomial};
+    for (size_t n = 1, row = 1; n < odd.size(); ++n, row <<= 1)
+    {
+        odd[n] = static_cast<std::uint32_t>(row);
+    }
+    auto even = gf2_square(odd);
+    odd       = gf2_square(even);
+
+    // apply size_b zero bytes to crc_a
+    do
+    {
+        even = gf2_square(odd);
+        if (size_b & 1)
+        {
+            crc_a = gf2_times(even, crc_a);
+        }
+        size_b >>= 1;
+        if (size_b == 0)
+        {
+            break;
+        }
+        odd = gf2_square(even);
+        if (size_b & 1)
+        {
+            crc_a = gf2_times(odd, crc_a);
+        }
+        size_b >>= 1;
+    } while (size_b != 0);
+
+    return crc_a ^ crc_b;
+}
+
+auto crc32c_isa() -> const char*  //
+{
+    return the_implementation().isa;
+}
+
+}  // namespace io
@@ -0,0 +1,29 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace io
+{
+
+/** CRC32C (Castagnoli) of the given memory, using the SSE4.2 crc32 instruction if available
+ *
+ * Chainable: crc32c(b, nb, crc32c(a, na)) is the checksum of a followed by b.
+ */
+[[nodiscard]] auto crc32c(const void* data, size_t size, std::uint32_t crc = 0) -> std::uint32_t;
+
+/** checksum of a block a followed by a block b of size_b, out of the checksums of a and b
+ */
+[[nodiscard]] auto crc32c_combine(std::uint32_t crc_a, std::uint32_t crc_b, size_t size_b) -> std::uint32_t;
+
+/** @return name of the implementation selected at runtime, i.e. sse4.2 or generic
+ */
+auto crc32c_isa() -> const char*;
+
+}  // namespace io
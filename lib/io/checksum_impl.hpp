@@ -0,0 +1,49 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+// internal helpers of the io library, shared by the checksum and the copy engine
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define IO_CRC_X86 1
+#endif
+
+namespace io::detail
+{
+#ifdef IO_CRC_X86
+/** raw crc32 state update with 8 bytes, no pre- or post-conditioning
+ */
+__attribute__((target("sse4.2"))) inline auto crc32c_u64(std::uint64_t state, const char* data) -> std::uint64_t
+{
+    auto v = std::uint64_t{};
+    std::memcpy(&v, data, sizeof(v));
+    return _mm_crc32_u64(state, v);
+}
+
+/** raw crc32 state update, no pre- or post-conditioning
+ */
+__attribute__((target("sse4.2"))) inline auto crc32c_update_hw(std::uint32_t state, const char* data, size_t size) -> std::uint32_t
+{
+    auto s = static_cast<std::uint64_t>(state);
+    for (; size >= sizeof(std::uint64_t); data += sizeof(std::uint64_t), size -= sizeof(std::uint64_t))
+    {
+        s = crc32c_u64(s, data);
+    }
+    auto crc = static_cast<std::uint32_t>(s);
+    for (; size > 0; ++data, --size)
+    {
+        crc = _mm_crc32_u8(crc, static_cast<unsigned char>(*data));
+    }
+    return crc;
+}
+#endif
+}  // namespace io::detail
@@ -0,0 +1,470 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "io/copy_engine.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+#include "io/checksum.hpp"
+#include "io/checksum_impl.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IO_COPY_X86 1
+#endif
+
+namespace io
+{
+namespace
+{
+using copy_fn = void (*)(char* dst, const char* src, size_t size);
+using fill_fn = void (*)(char* dst, char value, size_t size);
+using crc_fn  = std::uint32_t (*)(char* dst, const char* src, size_t size);
+
+constexpr size_t cache_line = 64;
+constexpr size_t page_size  = 4096;
+
+void generic_copy(char* dst, const char* src, size_t size) { std::memcpy(dst, src, size); }
+void generic_fill(char* dst, char value, size_t size) { std::memset(dst, value, size); }
+
+template <copy_fn copy>
+auto copy_then_crc(char* dst, const char* src, size_t size) -> std::uint32_t
+{
+    copy(dst, src, size);
+    return crc32c(src, size);
+}
+
+#ifdef IO_COPY_X86
+/** number of bytes to write with regular stores until dst is aligned for streaming stores
+ */
+auto unaligned_head(const char* dst, size_t alignment, size_t size) -> size_t
+{
+    auto misalignment = reinterpret_cast<std::uintptr_t>(dst) % alignment;
+    return std::min(size, misalignment ? alignment - misalignment : 0);
+}
+
+__attribute__((target("sse2"))) void stream_copy_sse2(char* dst, const char* src, size_t size)
+{
+    auto head = unaligned_head(dst, 16, size);
+    std::memcpy(dst, src, head);
+    dst += head, src += head, size -= head;
+
+    for (; size >= cache_line; dst += cache_line, src += cache_line, size -= cache_line)
+    {
+        auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+        auto c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+        auto d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), a);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 48), d);
+    }
+    _mm_sfence();
+    std::memcpy(dst, src, size);
+}
+
+__attribute__((target("sse2"))) void stream_fill_sse2(char* dst, char value, size_t size)
+{
+    auto head = unaligned_head(dst, 16, size);
+    std::memset(dst, value, head);
+    dst += head, size -= head;
+
+    auto v = _mm_set1_epi8(value);
+    for (; size >= cache_line; dst += cache_line, size -= cache_line)
+    {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), v);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 16), v);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 32), v);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 48), v);
+    }
+    _mm_sfence();
+    std::memset(dst, value, size);
+}
+
+__attribute__((target("avx2"))) void stream_copy_avx2(char* dst, const char* src, size_t size)
+{
+    auto head = unaligned_head(dst, 32, size);
+    std::memcpy(dst, src, head);
+    dst += head, src += head, size -= head;
+
+    for (; size >= 2 * cache_line; dst += 2 * cache_line, src += 2 * cache_line, size -= 2 * cache_line)
+    {
+        auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+        auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 64));
+        auto d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 96));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst), a);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 32), b);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 64), c);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 96), d);
+    }
+    _mm_sfence();
+    std::memcpy(dst, src, size);
+}
+
+__attribute__((target("avx2"))) void stream_fill_avx2(char* dst, char value, size_t size)
+{
+    auto head = unaligned_head(dst, 32, size);
+    std::memset(dst, value, head);
+    dst += head, size -= head;
+
+    auto v = _mm256_set1_epi8(value);
+    for (; size >= 2 * cache_line; dst += 2 * cache_line, size -= 2 * cache_line)
+    {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst), v);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 32), v);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 64), v);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 96), v);
+    }
+    _mm_sfence();
+    std::memset(dst, value, size);
+}
+#ifdef IO_CRC_X86
+/** stream 128 bytes to dst and update the raw crc state with them, while they are still in the registers / L1
+ */
+__attribute__((target("avx2,sse4.2"))) inline void stream_block_crc(char* dst, const char* src, std::uint64_t& state)
+{
+    auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+    auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 64));
+    auto d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 96));
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst), a);
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 32), b);
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 64), c);
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 96), d);
+    for (size_t i = 0; i < 2 * cache_line; i += sizeof(std::uint64_t))
+    {
+        state = detail::crc32c_u64(state, src + i);
+    }
+}
+
+__attribute__((target("avx2,sse4.2"))) auto stream_copy_crc_avx2(char* dst, const char* src, size_t size) -> std::uint32_t
+{
+    auto head = unaligned_head(dst, 32, size);
+    auto crc  = ~detail::crc32c_update_hw(~0U, src, head);
+    std::memcpy(dst, src, head);
+    dst += head, src += head, size -= head;
+
+    // three stripes, so the three crc dependency chains overlap each other and the memory transfer
+    constexpr size_t block  = 2 * cache_line;
+    auto             stripe = size / 3 / block * block;
+
+    std::uint64_t a = ~0U, b = ~0U, c = ~0U;
+    for (size_t i = 0; i < stripe; i += block)
+    {
+        stream_block_crc(dst + i, src + i, a);
+        stream_block_crc(dst + stripe + i, src + stripe + i, b);
+        stream_block_crc(dst + 2 * stripe + i, src + 2 * stripe + i, c);
+    }
+    _mm_sfence();
+    crc = crc32c_combine(crc, ~static_cast<std::uint32_t>(a), stripe);
+    crc = crc32c_combine(crc, ~static_cast<std::uint32_t>(b), stripe);
+    crc = crc32c_combine(crc, ~static_cast<std::uint32_t>(c), stripe);
+
+    auto rest = size - 3 * stripe;
+    crc       = crc32c_combine(crc, ~detail::crc32c_update_hw(~0U, src + 3 * stripe, rest), rest);
+    std::memcpy(dst + 3 * stripe, src + 3 * stripe, rest);
+    return crc;
+}
+#endif
+#endif
+
+/** Persistent helper threads that run one job split into equal parts.
+ *
+ * Only one job runs at a time, a concurrent caller gets rejected and has to
+ * do the work on its own.
+ */
+class helpers
+{
+   public:
+    /** non-owning reference to the callable of the running job, nothing is allocated per job */
+    struct job_t
+    {
+        const void* fn{nullptr};
+        void (*call)(const void* fn, unsigned part, unsigned parts){nullptr};
+    };
+
+    explicit helpers(unsigned n) : slots(n)
+    {
+        for (auto& s : slots)
+        {
+            s        = std::make_unique<slot>();
+            auto idx = static_cast<unsigned>(&s - slots.data());
+            s->thread = std::jthread{[this, idx]() { work(idx); }};
+        }
+    }
+
+    helpers(const helpers& other) = delete;
+    auto operator=(const helpers& rhs) -> helpers& = delete;
+
+    helpers(helpers&& rhs) noexcept = delete;
+    auto operator=(helpers&& rhs) noexcept -> helpers& = delete;
+
+    ~helpers()
+    {
+        stopping = true;
+        for (auto& s : slots)
+        {
+            s->start.release();
+        }
+        // join before the other members go away, the workers still read them
+        for (auto& s : slots)
+        {
+            s->thread.join();
+        }
+    }
+
+    /** run the job on all helpers and the calling thread
+     * @return false if the helpers are busy with another job
+     */
+    template <typename F>
+    auto run(const F& j) -> bool
+    {
+        auto lock = std::unique_lock<std::mutex>{busy, std::try_to_lock};
+        if (!lock)
+        {
+            return false;
+        }
+
+        job = job_t{&j, [](const void* fn, unsigned part, unsigned parts) { (*static_cast<const F*>(fn))(part, parts); }};
+        for (auto& s : slots)
+        {
+            s->start.release();
+        }
+        j(static_cast<unsigned>(slots.size()), parts());
+        for (size_t i = 0; i < slots.size(); ++i)
+        {
+            done.acquire();
+        }
+        return true;
+    }
+
+    [[nodiscard]] auto parts() const -> unsigned { return static_cast<unsigned>(slots.size()) + 1; }
+
+   private:
+    struct slot
+    {
+        std::binary_semaphore start{0};
+        std::jthread          thread;
+    };
+
+    void work(unsigned idx)
+    {
+        while (true)
+        {
+            slots[idx]->start.acquire();
+            if (stopping)
+            {
+                return;
+            }
+            job.call(job.fn, idx, parts());
+            done.release();
+        }
+    }
+
+    std::vector<std::unique_ptr<slot>> slots;
+    std::counting_semaphore<>          done{0};
+    std::mutex                         busy;
+    std::atomic<bool>                  stopping{false};
+    job_t                              job;
+};
+
+struct engine
+{
+    engine()
+    {
+#ifdef IO_COPY_X86
+        if (__builtin_cpu_supports("avx2"))
+        {
+            isa         = "avx2";
+            stream_copy = stream_copy_avx2;
+            stream_fill = stream_fill_avx2;
+            stream_crc  = copy_then_crc<stream_copy_avx2>;
+#ifdef IO_CRC_X86
+            if (__builtin_cpu_supports("sse4.2"))
+            {
+                stream_crc = stream_copy_crc_avx2;
+            }
+#endif
+        }
+        else if (__builtin_cpu_supports("sse2"))
+        {
+            isa         = "sse2";
+            stream_copy = stream_copy_sse2;
+            stream_fill = stream_fill_sse2;
+            stream_crc  = copy_then_crc<stream_copy_sse2>;
+        }
+#endif
+        // parallel copies only pay off if there are spare cores beside the producer and the consumer
+        auto cfg    = copy_config{};
+        cfg.threads = std::thread::hardware_concurrency() >= 8 ? 2 : 0;
+        configure(cfg);
+    }
+
+    void configure(copy_config c)
+    {
+        c.threads = std::min(c.threads, max_copy_threads);
+        if (!pool || pool->parts() != c.threads + 1)
+        {
+            pool.reset();
+            if (c.threads > 0)
+            {
+                pool = std::make_unique<helpers>(c.threads);
+            }
+        }
+        cfg = c;
+    }
+
+    /** split [0, size) into page aligned parts and let the helpers process them
+     * @return false if the helpers are not available
+     */
+    auto parallel(size_t size, const auto& fn) -> bool
+    {
+        if (!pool || size < cfg.parallel_threshold)
+        {
+            return false;
+        }
+        return pool->run(
+            [size, &fn](unsigned part, unsigned parts)
+            {
+                auto chunk = (size / parts + page_size - 1) / page_size * page_size;
+                auto begin = std::min(size, part * chunk);
+                auto end   = std::min(size, begin + chunk);
+                if (begin < end)
+                {
+                    fn(part, begin, end - begin);
+                }
+            });
+    }
+
+    [[nodiscard]] auto parts() const -> unsigned { return pool ? pool->parts() : 1; }
+
+    copy_config              cfg;
+    const char*              isa         = "generic";
+    copy_fn                  stream_copy = generic_copy;
+    fill_fn                  stream_fill = generic_fill;
+    crc_fn                   stream_crc  = copy_then_crc<generic_copy>;
+    std::unique_ptr<helpers> pool;
+};
+
+auto the_engine() -> engine&
+{
+    static auto e = engine{};
+    return e;
+}
+
+}  // namespace
+
+void configure_copy(copy_config const& cfg)  //
+{
+    the_engine().configure(cfg);
+}
+
+auto copy_configuration() -> copy_config  //
+{
+    return the_engine().cfg;
+}
+
+auto copy_isa() -> const char*  //
+{
+    return the_engine().isa;
+}
+
+void copy_memory(void* dst, const void* src, size_t size)
+{
+    auto& e = the_engine();
+    auto* d = static_cast<char*>(dst);
+    auto* s = static_cast<const char*>(src);
+    if (!e.cfg.streaming || size < e.cfg.stream_threshold)
+    {
+        std::memcpy(d, s, size);
+        return;
+    }
+
+    // the head stays in the cache for the reader, the rest bypasses it
+    auto head = std::min(size, e.cfg.cached_head);
+    std::memcpy(d, s, head);
+    d += head, s += head, size -= head;
+
+    if (!e.parallel(size, [&e, d, s](unsigned, size_t offset, size_t len) { e.stream_copy(d + offset, s + offset, len); }))
+    {
+        e.stream_copy(d, s, size);
+    }
+}
+
+void fill_memory(void* dst, char value, size_t size)
+{
+    auto& e = the_engine();
+    auto* d = static_cast<char*>(dst);
+    if (!e.cfg.streaming || size < e.cfg.stream_threshold)
+    {
+        std::memset(d, value, size);
+        return;
+    }
+
+    if (!e.parallel(size, [&e, d, value](unsigned, size_t offset, size_t len) { e.stream_fill(d + offset, value, len); }))
+    {
+        e.stream_fill(d, value, size);
+    }
+}
+
+auto copy_memory_crc32c(void* dst, const void* src, size_t size, size_t crc_offset) -> std::uint32_t
+{
+    auto& e = the_engine();
+    auto* d = static_cast<char*>(dst);
+    auto* s = static_cast<const char*>(src);
+    crc_offset = std::min(crc_offset, size);
+    if (!e.cfg.streaming || size < e.cfg.stream_threshold)
+    {
+        std::memcpy(d, s, size);
+        return crc32c(s + crc_offset, size - crc_offset);
+    }
+
+    // the head stays in the cache for the reader, the rest bypasses it
+    auto head = std::min(size, std::max(e.cfg.cached_head, crc_offset));
+    auto crc  = crc32c(s + crc_offset, head - crc_offset);
+    std::memcpy(d, s, head);
+    d += head, s += head, size -= head;
+
+    // parts that get no data keep a length of 0, combining them is a no-op
+    auto part_crc = std::array<std::uint32_t, max_copy_threads + 1>{};
+    auto part_len = std::array<size_t, max_copy_threads + 1>{};
+    if (!e.parallel(size,
+                    [&e, &part_crc, &part_len, d, s](unsigned part, size_t offset, size_t len)
+                    {
+                        part_crc[part] = e.stream_crc(d + offset, s + offset, len);
+                        part_len[part] = len;
+                    }))
+    {
+        return crc32c_combine(crc, e.stream_crc(d, s, size), size);
+    }
+    for (size_t part = 0; part < e.parts(); ++part)
+    {
+        crc = crc32c_combine(crc, part_crc[part], part_len[part]);
+    }
+    return crc;
+}
+
+void prefetch(const void* src, size_t size)
+{
+    const auto* s = static_cast<const char*>(src);
+    for (size_t i = 0; i < size; i += cache_line)
+    {
+        __builtin_prefetch(s + i, 0, 3);
+    }
+}
+
+}  // namespace io
@@ -0,0 +1,55 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace io
+{
+
+/** upper limit of copy_config::threads */
+constexpr unsigned max_copy_threads = 15;
+
+/** tuning of the copy / fill engine
+ */
+struct copy_config
+{
+    size_t   stream_threshold   = 256 * 1024;       // use non-temporal stores from this size on
+    size_t   parallel_threshold = 8 * 1024 * 1024;  // split copies from this size on across the helper threads
+    size_t   cached_head        = 4096;             // front of the destination written cache resident, the reader touches it first
+    unsigned threads            = 0;                // number of helper threads for parallel copies, 0 disables them, at most max_copy_threads
+    bool     streaming          = true;             // false forces plain memcpy / memset
+};
+
+/** reconfigure the engine. Not thread safe, call it before any copy is in flight.
+ */
+void configure_copy(copy_config const& cfg);
+auto copy_configuration() -> copy_config;
+
+/** @return name of the instruction set selected at runtime, i.e. avx2, sse2 or generic
+ */
+auto copy_isa() -> const char*;
+
+/** copy large blocks of memory that are written once and read later by someone else
+ *
+ * Large blocks are written with non-temporal stores, so they do not evict the
+ * caches of the writing core, and very large blocks are split across helper threads.
+ */
+void copy_memory(void* dst, const void* src, size_t size);
+void fill_memory(void* dst, char value, size_t size);
+
+/** copy like copy_memory and compute the CRC32C of src[crc_offset, size) on the fly,
+ * while the data passes the registers anyway
+ */
+[[nodiscard]] auto copy_memory_crc32c(void* dst, const void* src, size_t size, size_t crc_offset = 0) -> std::uint32_t;
+
+/** hint the cpu to load the given memory into the cache of the calling core
+ */
+void prefetch(const void* src, size_t size);
+
+}  // namespace io
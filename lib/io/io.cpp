@@ -6,37 +6,84 @@
 
 #include "io/io.hpp"
 
+#include "io/checksum.hpp"
+#include "io/copy_engine.hpp"
+
 #include <array>
+#include <atomic>
+#include <cstring>
 #include <iostream>
+#include <mutex>
 
 namespace io
 {
 
-static auto io_buffer = std::array<char, io::frame_size>{};
-static auto get_cnt   = 0;
-static auto send_cnt  = 0;
+static auto io_buffer       = std::array<char, io::frame_size>{};
+static auto io_lock         = std::mutex{};  // the simulated hardware has a single transfer buffer
+static auto buffer_fill_cnt = 0;
+static auto get_cnt         = std::atomic<std::uint64_t>{0};
+static auto send_cnt        = std::atomic<std::uint64_t>{0};
 
-void get_data(std::span<char, frame_size> const& output)
+static void prepare_buffer()
 {
     // prepare output buffer (usually done by HW) ...
-    static auto buffer_fill_cnt = 0;
-    io_buffer.fill('a' + (buffer_fill_cnt++ % 26));
+    // with cached stores, the copy below reads the buffer right back. Only the output frame is streamed.
+    std::memset(io_buffer.data(), 'a' + (buffer_fill_cnt++ % 26), io_buffer.size());
+}
+
+void get_data(std::span<char, frame_size> const& output)
+{
+    auto guard = std::lock_guard<std::mutex>{io_lock};
+    prepare_buffer();
 
     // ... and transfer it to the caller
-    std::copy(io_buffer.begin(), io_buffer.end(), output.begin());
-    get_cnt++;
+    copy_memory(output.data(), io_buffer.data(), output.size());
+    get_cnt.fetch_add(1, std::memory_order_relaxed);
     // std::cout << "[io] get_data " << output[0] << "\n";
 }
 
+auto get_data_checked(std::span<char, frame_size> const& output) -> std::uint32_t
+{
+    auto guard = std::lock_guard<std::mutex>{io_lock};
+    prepare_buffer();
+
+    // ... and transfer it to the caller, checksum the data on the way
+    auto crc = copy_memory_crc32c(output.data(), io_buffer.data(), output.size(), header_size);
+    get_cnt.fetch_add(1, std::memory_order_relaxed);
+    return crc;
+}
+
+auto checksum(std::span<const char, frame_size> const& frame) -> std::uint32_t  //
+{
+    return crc32c(frame.data() + header_size, frame.size() - header_size);
+}
+
 void send_data(std::span<const char, frame_size> const&)
 {
-    send_cnt++;
+    send_cnt.fetch_add(1, std::memory_order_relaxed);
     // std::cout << "[io] send_data(" << output.data() << ")\n";
 }
 
+void prefault()
+{
+    auto guard = std::lock_guard<std::mutex>{io_lock};
+    io_buffer.fill('\0');
+}
+
+void reset_statistics()
+{
+    get_cnt  = 0;
+    send_cnt = 0;
+}
+
+auto transfers() -> transfer_statistics  //
+{
+    return {get_cnt.load(std::memory_order_relaxed), send_cnt.load(std::memory_order_relaxed)};
+}
+
 void print_statistics()
 {
-    auto lost = 100 - ((100 * send_cnt) / get_cnt);
+    auto lost = get_cnt ? 100 - ((100 * send_cnt) / get_cnt) : 0;
     std::cout << "[io] Statistics:\n"
               << "\tget_data: " << get_cnt << "\n\tsend_data: " << send_cnt << "\n"
               << "\tlost: " << lost << "%\n";
@@ -7,13 +7,42 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <span>
 
 namespace io
 {
 
-constexpr size_t frame_size = 16 * 1024 * 1024;
+constexpr size_t frame_size  = 16 * 1024 * 1024;
+constexpr size_t header_size = 64;  // front of a frame, may be rewritten during post processing
 void             get_data(std::span<char, frame_size> const& output);
 void             send_data(std::span<const char, frame_size> const& output);
 void             print_statistics();
+
+/** like get_data, and return the CRC32C of the captured data behind the header.
+ * The checksum is computed during the transfer.
+ */
+[[nodiscard]] auto get_data_checked(std::span<char, frame_size> const& output) -> std::uint32_t;
+
+/** CRC32C of the frame data behind the header
+ */
+[[nodiscard]] auto checksum(std::span<const char, frame_size> const& frame) -> std::uint32_t;
+
+/** touch the internal transfer buffer so the first get_data does not page-fault
+ */
+void prefault();
+
+/** forget the get / send counters, e.g. after a warm-up phase
+ */
+void reset_statistics();
+
+struct transfer_statistics
+{
+    std::uint64_t get_data{0};
+    std::uint64_t send_data{0};
+};
+
+/** number of transferred frames so far, lock-free
+ */
+[[nodiscard]] auto transfers() -> transfer_statistics;
 }  // namespace io
@@ -6,20 +6,60 @@
 
 #include "consumer/runnable.hpp"
 
+#include <utility>
+
+#include "cpc/metrics.hpp"
+#include "utils/trace.hpp"
+
 namespace consumer
 {
-runnable::runnable(mq_t& q, send_data_t sd, dispatcher_t dp)  //
-    : queue{q}, send_data{std::move(sd)}, dispatcher{std::move(dp)}
+runnable::runnable(mq_t& q, size_t w, send_data_t sd, dispatcher_t dp, verify_t v)  //
+    : queue{q}, worker{w}, send_data{std::move(sd)}, dispatcher{std::move(dp)}, verify{std::move(v)}
 {
 }
 
 auto runnable::operator()() -> void
 {
-    if (auto msg = queue.dequeue(); msg)
+    auto wait = utils::trace::clock::now();
+    if (auto msg = queue.dequeue(worker); msg)
     {
+        utils::trace::record("dequeue", msg->id, wait);
+        auto trace = utils::trace::scope{"consume", msg->id};
+
+        using clock   = std::chrono::steady_clock;
+        auto& metrics = cpc::metrics();
+        auto  begin   = clock::now();
+        metrics.queued.observe(begin - msg->enqueued);
+
         // dispatch the message
         // apply some sort of data transformation / aggregation or filtering prior to passing the data on
-        send_data(dispatcher(*msg));
+        auto output = dispatcher(*msg);
+        auto end    = clock::now();
+        metrics.dispatch.observe(end - begin);
+
+        if (verify)
+        {
+            auto stage = utils::trace::scope{"verify"};
+            auto valid = verify(*msg);
+            begin      = std::exchange(end, clock::now());
+            metrics.verify.observe(end - begin);
+            if (!valid)
+            {
+                // never pass on data known to be broken
+                metrics.dropped_corrupt.add();
+                return;
+            }
+        }
+
+        {
+            auto stage = utils::trace::scope{"send_data"};
+            send_data(output);
+        }
+        begin = std::exchange(end, clock::now());
+        metrics.send_data.observe(end - begin);
+        metrics.end_to_end.observe(end - msg->captured);
+        metrics.first_sent(end - msg->captured);
+        metrics.consumed.add();
     }
 }
 
@@ -5,7 +5,9 @@
  */
 
 #pragma once
+#include <functional>
 #include <iostream>
+#include <span>
 #include <vector>
 
 #include "cpc/message_queue.hpp"
@@ -17,14 +19,18 @@ class runnable
    public:
     using mq_t         = cpc::message_queue;
     using send_data_t  = std::function<void(std::span<const char, cpc::frame_size> const& output)>;
-    using dispatcher_t = std::function<std::span<const char, cpc::frame_size>(cpc::frame& output)>;
+    using dispatcher_t = std::function<std::span<const char, cpc::frame_size>(cpc::message& msg)>;
+    using verify_t     = std::function<bool(const cpc::message& msg)>;
 
     /** construct a consumer runnable
      * @param q     message queue, the runners synchronization point
+     * @param w     the worker index of this consumer at the queue
      * @param sd    i/o interface for sending post processed data back to the hardware
      * @param dp    message dispatcher hook
+     * @param v     optional integrity check of the message right before it is sent,
+     *              a message that fails the check is dropped
      */
-    runnable(mq_t& q, send_data_t sd, dispatcher_t dp);
+    runnable(mq_t& q, size_t w, send_data_t sd, dispatcher_t dp, verify_t v = {});
 
     /** Wait for message arrival on the queue. 
      * 
@@ -37,7 +43,9 @@ class runnable
 
    private:
     mq_t&        queue;
+    size_t       worker;
     send_data_t  send_data;
     dispatcher_t dispatcher;
+    verify_t     verify;
 };
 }  // namespace consumer
@@ -0,0 +1,143 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "cpc/message_queue.hpp"
+#include "io/io.hpp"
+
+namespace cpc
+{
+
+/** Verify the trailer of messages before they are sent.
+ *
+ * Detects corrupted payloads by their checksum, and sequence gaps, late
+ * (reordered) and duplicated frames per lane. Every lane remembers which of
+ * its last `window` sequences arrived, so a late frame closes its gap again
+ * while a duplicate does not. A frame older than the window cannot be told
+ * apart from a duplicate and is counted as one. A trailer naming an unknown
+ * lane is corrupt by itself. Lanes are guarded separately,
+ * so only the owner of a lane and a thief can meet on the same lock. The
+ * counters are read lock-free.
+ */
+class integrity_checker
+{
+   public:
+    static constexpr std::uint64_t window = 1024;
+
+    explicit integrity_checker(size_t lanes) : states(lanes) {}
+
+    /** @return false if the payload does not match its checksum
+     */
+    auto operator()(const message& msg) -> bool
+    {
+        checked_cnt.fetch_add(1, std::memory_order_relaxed);
+        if (msg.tail.lane >= states.size())
+        {
+            corrupt_cnt.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        track_sequence(msg.tail);
+
+        if (!msg.tail.sealed)
+        {
+            return true;
+        }
+        auto frame = std::visit([](const auto& f) { return std::span<const char, frame_size>{f}; }, msg.payload);
+        if (io::checksum(frame) != msg.tail.checksum)
+        {
+            corrupt_cnt.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] auto checked() const -> std::uint64_t { return checked_cnt.load(std::memory_order_relaxed); }
+    [[nodiscard]] auto corrupt() const -> std::uint64_t { return corrupt_cnt.load(std::memory_order_relaxed); }
+    [[nodiscard]] auto missing() const -> std::uint64_t { return missing_cnt.load(std::memory_order_relaxed); }
+    [[nodiscard]] auto reordered() const -> std::uint64_t { return reordered_cnt.load(std::memory_order_relaxed); }
+    [[nodiscard]] auto duplicated() const -> std::uint64_t { return duplicated_cnt.load(std::memory_order_relaxed); }
+
+    /** zero the counters, e.g. after the warm-up. The sequences seen so far are kept,
+     * so the frames that follow are not taken for a gap.
+     */
+    void reset_statistics()
+    {
+        for (auto* c : {&checked_cnt, &corrupt_cnt, &missing_cnt, &reordered_cnt, &duplicated_cnt})
+        {
+            c->store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void print_statistics() const
+    {
+        std::cout << "[integrity] Statistics:\n"
+                  << "\tchecked: " << checked() << "\n\tcorrupt: " << corrupt() << "\n"
+                  << "\tmissing: " << missing() << "\n\treordered: " << reordered() << "\n"
+                  << "\tduplicated: " << duplicated() << "\n";
+    }
+
+   private:
+    struct lane_state
+    {
+        std::mutex          guard;
+        std::uint64_t       highest{0};  // highest sequence seen, sequences start with 1
+        std::bitset<window> seen;        // arrival of the sequences (highest - window, highest]
+    };
+
+    void track_sequence(const trailer& tail)
+    {
+        auto& state = states[tail.lane];
+        auto  lock  = std::lock_guard<std::mutex>{state.guard};
+        auto  seq   = tail.sequence;
+
+        if (seq > state.highest)
+        {
+            // frames in between are missing, at least till they arrive late
+            auto gap = seq - state.highest - 1;
+            if (gap >= window)
+            {
+                state.seen.reset();
+            }
+            for (auto s = state.highest + 1; s < seq && gap < window; ++s)
+            {
+                state.seen.reset(s % window);
+            }
+            state.seen.set(seq % window);
+            state.highest = seq;
+            missing_cnt.fetch_add(gap, std::memory_order_relaxed);
+        }
+        else if (seq + window > state.highest && !state.seen.test(seq % window))
+        {
+            // closes a gap that was counted as missing before
+            state.seen.set(seq % window);
+            reordered_cnt.fetch_add(1, std::memory_order_relaxed);
+            missing_cnt.fetch_sub(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            duplicated_cnt.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::vector<lane_state>    states;
+    std::atomic<std::uint64_t> checked_cnt{0};
+    std::atomic<std::uint64_t> corrupt_cnt{0};
+    std::atomic<std::uint64_t> missing_cnt{0};
+    std::atomic<std::uint64_t> reordered_cnt{0};
+    std::atomic<std::uint64_t> duplicated_cnt{0};
+};
+
+}  // namespace cpc
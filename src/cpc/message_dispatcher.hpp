@@ -6,17 +6,19 @@
 
 #pragma once
 
-#include <chrono>
 #include <span>
 #include <string_view>
 
 #include "cpc/message_queue.hpp"
+#include "io/copy_engine.hpp"
+#include "utils/load_model.hpp"
+#include "utils/trace.hpp"
 
 namespace cpc
 {
 using namespace std::literals;
 
-template <typename T = cpc::frame>
+template <typename T = cpc::message>
 struct message_dispatcher
 {
     auto operator()(auto&)  //
@@ -26,41 +28,58 @@ struct message_dispatcher
 };
 
 template <>
-struct message_dispatcher<cpc::frame>
+struct message_dispatcher<cpc::message>
 {
-    auto operator()(auto& frame)
+    /**
+     * @param l  cost model of the processing, applied to every frame after the type specific part
+     */
+    explicit message_dispatcher(utils::load_model l = {}) : load{l} {}
+
+    auto operator()(auto& msg)
     {
         // dispatch the concrete type. video, audio, hw or network
+        auto trace = utils::trace::scope{"dispatch"};
         return std::visit(
-            [](auto& arg)
+            [this, id = msg.id, warm_up = msg.warm_up](auto& arg)
             {
                 using T = std::decay_t<decltype(arg)>;
+                // only the head the dispatcher writes to, the streamed payload stays in memory
+                io::prefetch(arg.data(), io::copy_configuration().cached_head);
                 message_dispatcher<T>{}(arg);
+                if (!warm_up)
+                {
+                    load.apply(id, arg);
+                }
                 return std::span<char, cpc::frame_size>{arg};
             },
-            frame);
+            msg.payload);
     }
+
+   private:
+    utils::load_model load;
 };
 
 template <>
 struct message_dispatcher<video_frame>
 {
+    static constexpr auto default_load = "io:constant:10000"sv;  // a video encoder waiting for its hardware
+
     auto operator()(auto& frame)  //
     {
         constexpr auto s = "video_frame\0"sv;
         s.copy(frame.data(), s.size());
-        std::this_thread::sleep_for(10ms); // simulate some load
     }
 };
 
 template <>
 struct message_dispatcher<audio_frame>
 {
+    static constexpr auto default_load = "io:constant:20000"sv;  // an audio dsp waiting for its hardware
+
     auto operator()(auto& frame)  //
     {
         constexpr auto s = "audio_frame\0"sv;
         s.copy(frame.data(), s.size());
-        std::this_thread::sleep_for(20ms); // simulate some load
     }
 };
 
@@ -68,6 +87,8 @@ template <>
 struct message_dispatcher<hw_frame>
 {
    public:
+    static constexpr auto default_load = "none"sv;
+
     auto operator()(auto& frame)  //
     {
         constexpr auto s = "hw_frame\0"sv;
@@ -79,11 +100,12 @@ template <>
 struct message_dispatcher<network_frame>
 {
    public:
+    static constexpr auto default_load = "io:constant:30000"sv;  // a network stack waiting for the peer
+
     auto operator()(auto& frame)  //
     {
         constexpr auto s = "network_frame\0"sv;
         s.copy(frame.data(), s.size());
-        std::this_thread::sleep_for(30ms);  // simulate some load
     }
 };
 
@@ -6,19 +6,24 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <variant>
 
 #include "io/io.hpp"
-#include "utils/message_queue.hpp"
+#include "utils/object_pool.hpp"
+#include "utils/sharded_queue.hpp"
 
 namespace cpc
 {
-constexpr size_t frame_size = io::frame_size;
-constexpr size_t queue_size = 10;
+constexpr size_t frame_size  = io::frame_size;
+constexpr size_t header_size = io::header_size;  // the dispatchers write the frame header in here
 
 struct raw_frame : public std::array<char, frame_size>
 {
-    raw_frame()                       = default;
+    // user provided, so (value-)initializing a frame does not zero the whole payload.
+    // The payload gets overwritten by get_data anyway.
+    raw_frame() {}  // NOLINT(modernize-use-equals-default)
     raw_frame(const raw_frame& other) = delete;
     auto operator=(const raw_frame& rhs) -> raw_frame& = delete;
     raw_frame(raw_frame&& rhs) noexcept                = delete;
@@ -28,20 +33,56 @@ struct raw_frame : public std::array<char, frame_size>
 
 struct video_frame : public raw_frame
 {
+    video_frame() {}  // NOLINT(modernize-use-equals-default)
 };
 
 struct audio_frame : public raw_frame
 {
+    audio_frame() {}  // NOLINT(modernize-use-equals-default)
 };
 
 struct hw_frame : public raw_frame
 {
+    hw_frame() {}  // NOLINT(modernize-use-equals-default)
 };
 
 struct network_frame : public raw_frame
 {
+    network_frame() {}  // NOLINT(modernize-use-equals-default)
 };
 
-using frame         = std::variant<raw_frame, video_frame, hw_frame, audio_frame, network_frame>;
-using message_queue = utils::message_queue<frame, queue_size>;
+using frame = std::variant<raw_frame, video_frame, hw_frame, audio_frame, network_frame>;
+
+/** integrity information of a frame, filled in at capture and verified before it is sent
+ */
+struct trailer
+{
+    size_t        lane{0};
+    std::uint64_t sequence{0};  // per lane, starts with 1
+    std::uint32_t checksum{0};  // CRC32C of the payload behind the header
+    bool          sealed{false};  // checksum is valid
+};
+
+/** the transport unit of the queue. The domain specific frame plus its meta data
+ */
+struct message
+{
+    frame         payload;
+    std::uint64_t id{0};  // frame id, assigned by the producer
+    trailer       tail;
+    bool          warm_up{false};  // dummy frame of the warm-up, the simulated loads are skipped
+
+    std::chrono::steady_clock::time_point captured;  // get_data started
+    std::chrono::steady_clock::time_point enqueued;  // handed over to the queue
+};
+
+using message_queue = utils::sharded_queue<message>;
+using frame_pool    = utils::object_pool<message>;
+
+/** number of frames needed to fill all lanes of the queue, plus one in every producer and consumer
+ */
+constexpr auto pool_size(size_t lanes, size_t queue_size, size_t consumers) -> size_t
+{
+    return lanes * queue_size + lanes + consumers;
+}
 }  // namespace cpc
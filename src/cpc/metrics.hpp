@@ -0,0 +1,98 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <initializer_list>
+
+#include "utils/metrics.hpp"
+
+namespace cpc
+{
+
+/** metrics updated on the data path of producers and consumers
+ */
+struct pipeline_metrics
+{
+    explicit pipeline_metrics(utils::metrics::registry& r)
+        : produced{r.make_counter("cpc_frames_produced_total", "frames gathered from the hardware and enqueued")},
+          consumed{r.make_counter("cpc_frames_consumed_total", "frames dispatched and sent")},
+          dropped_pool{r.make_counter("cpc_frames_dropped_total", "frames dropped on overload or corruption", {{"reason", "pool_exhausted"}})},
+          dropped_queue{r.make_counter("cpc_frames_dropped_total", "frames dropped on overload or corruption", {{"reason", "queue_full"}})},
+          dropped_corrupt{r.make_counter("cpc_frames_dropped_total", "frames dropped on overload or corruption", {{"reason", "corrupt"}})},
+          tick_overruns{r.make_counter("cpc_tick_overruns_total", "producer ticks that fired while the previous frame was still in progress")},
+          get_data{stage(r, "get_data")},
+          enqueue{stage(r, "enqueue")},
+          queued{stage(r, "queued")},
+          dispatch{stage(r, "dispatch")},
+          verify{stage(r, "verify")},
+          send_data{stage(r, "send_data")},
+          end_to_end{stage(r, "end_to_end")},
+          first_frame{r.make_gauge("cpc_first_frame_latency_seconds", "time from the capture to the send of the first frame")}
+    {
+    }
+
+    /** record the latency of a sent frame from its capture, only the first frame of the process counts
+     */
+    auto first_sent(std::chrono::nanoseconds latency) -> void
+    {
+        if (!first_frame_sent.exchange(true, std::memory_order_relaxed))
+        {
+            first_frame.set(std::chrono::duration<double>{latency}.count());
+        }
+    }
+
+    /** start over, e.g. after the warm-up. Observations in flight may still land in the old values.
+     */
+    auto reset() -> void
+    {
+        for (auto* c : {&produced, &consumed, &dropped_pool, &dropped_queue, &dropped_corrupt, &tick_overruns})
+        {
+            c->reset();
+        }
+        for (auto* h : {&get_data, &enqueue, &queued, &dispatch, &verify, &send_data, &end_to_end})
+        {
+            h->reset();
+        }
+        first_frame.set(0);
+        first_frame_sent.store(false, std::memory_order_relaxed);
+    }
+
+    utils::metrics::counter&   produced;
+    utils::metrics::counter&   consumed;
+    utils::metrics::counter&   dropped_pool;
+    utils::metrics::counter&   dropped_queue;
+    utils::metrics::counter&   dropped_corrupt;
+    utils::metrics::counter&   tick_overruns;
+    utils::metrics::histogram& get_data;
+    utils::metrics::histogram& enqueue;
+    utils::metrics::histogram& queued;  // from enqueue to dequeue
+    utils::metrics::histogram& dispatch;
+    utils::metrics::histogram& verify;
+    utils::metrics::histogram& send_data;
+    utils::metrics::histogram& end_to_end;  // from the start of get_data to the end of send_data
+    utils::metrics::gauge&     first_frame;
+
+   private:
+    std::atomic<bool> first_frame_sent{false};
+
+    static auto stage(utils::metrics::registry& r, const char* name) -> utils::metrics::histogram&
+    {
+        return r.make_histogram("cpc_stage_latency_seconds", "time spent per frame in a processing stage", {{"stage", name}});
+    }
+};
+
+/** the pipeline metrics of the process, registered in the default registry
+ */
+inline auto metrics() -> pipeline_metrics&
+{
+    static auto m = pipeline_metrics{utils::metrics::default_registry()};
+    return m;
+}
+
+}  // namespace cpc
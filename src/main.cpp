@@ -4,23 +4,40 @@
  * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
  */
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/program_options.hpp>
 #include <chrono>
+#include <cmath>
+#include <fstream>
+#include <initializer_list>
 #include <iostream>
 #include <queue>
+#include <memory>
+#include <optional>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "consumer/runnable.hpp"
+#include "cpc/integrity.hpp"
 #include "cpc/message_dispatcher.hpp"
 #include "cpc/message_queue.hpp"
+#include "cpc/metrics.hpp"
+#include "io/copy_engine.hpp"
 #include "io/io.hpp"
 #include "producer/runnable.hpp"
+#include "utils/load_model.hpp"
+#include "utils/memory.hpp"
+#include "utils/metrics_server.hpp"
 #include "utils/thread_runner.hpp"
+#include "utils/trace.hpp"
+#include "utils/wait_strategy.hpp"
 
 namespace po = boost::program_options;
 using namespace std::literals;
@@ -28,6 +45,45 @@ using namespace std::literals;
 static constexpr int min_runtime    = 10;
 static constexpr int min_throughput = 10;
 static constexpr int max_throughput = 1000;
+static constexpr int warmup_frames  = 3;
+static constexpr int queue_size     = 10;
+
+/**
+ * Load model of the dispatchers if not given on the command line
+ */
+static auto default_dispatch_load(std::string_view domain) -> std::string_view
+{
+    return (domain == "video"sv)   ? cpc::message_dispatcher<cpc::video_frame>::default_load
+           : (domain == "audio"sv) ? cpc::message_dispatcher<cpc::audio_frame>::default_load
+           : (domain == "hw"sv)    ? cpc::message_dispatcher<cpc::hw_frame>::default_load
+                                   : cpc::message_dispatcher<cpc::network_frame>::default_load;
+}
+
+/**
+ * The arrival model of the producer ticks, its gaps are drawn around the tick period of --throughput.
+ */
+static auto arrival_spec(const po::variables_map& vm) -> utils::load_spec
+{
+    const auto& arrivals = vm["arrivals"].as<std::string>();
+    auto        sep      = arrivals.find(':');
+    auto        spec     = std::string{"io:"};
+    spec.append(arrivals, 0, sep);
+    spec += ':';
+    spec += std::to_string(1000 * (1000 / vm["throughput"].as<int>()));
+    if (sep != std::string::npos)
+    {
+        spec.append(arrivals, sep);
+    }
+    return utils::parse_load_spec(spec);
+}
+
+/**
+ * @return true if any of the options was given on the command line, not just defaulted
+ */
+static auto given(const po::variables_map& vm, std::initializer_list<const char*> args) -> bool
+{
+    return std::any_of(args.begin(), args.end(), [&vm](const char* arg) { return vm.count(arg) && !vm[arg].defaulted(); });
+}
 
 /**
  * Validate command line arguments
@@ -52,6 +108,123 @@ static void check_args(const po::variables_map& vm)
             throw std::out_of_range("--runtime argument is out of range");
         std::cout << "[args] Program runtime was set to " << vm["runtime"].as<int>() << " seconds\n";
     }
+    if (vm.count("warmup"))
+    {
+        if (auto w = vm["warmup"].as<int>(); w < 0)  //
+            throw std::out_of_range("--warmup argument is out of range");
+    }
+    for (const auto* arg : {"lanes", "consumers", "queue-size"})
+    {
+        if (vm.count(arg) && vm[arg].as<int>() < 1)  //
+            throw std::out_of_range("--"s + arg + " argument is out of range");
+    }
+    if (given(vm, {"lanes", "consumers", "queue-size"}))
+    {
+        std::cout << "[args] Queue has " << vm["lanes"].as<int>() << " lanes of depth " << vm["queue-size"].as<int>() << ", served by "
+                  << vm["consumers"].as<int>() << " consumers, offering " << vm["lanes"].as<int>() * vm["throughput"].as<int>()
+                  << " frames per second\n";
+    }
+    if (vm.count("wait"))
+    {
+        auto policy = utils::parse_wait_policy(vm["wait"].as<std::string>());  // throws on unknown policies
+        if (vm["spin-budget"].as<int>() < 0)  //
+            throw std::out_of_range("--spin-budget argument is out of range");
+        if (policy != utils::wait_policy::block)
+            std::cout << "[args] Consumers wait with " << utils::to_string(policy) << ", spin budget " << vm["spin-budget"].as<int>() << "us\n";
+    }
+    {
+        // throws on malformed load specs
+        auto capture  = utils::parse_load_spec(vm["capture-load"].as<std::string>());
+        auto dispatch = utils::parse_load_spec(vm.count("dispatch-load") ? vm["dispatch-load"].as<std::string>()
+                                                                         : default_dispatch_load(vm["domain"].as<std::string>()));
+        auto arrivals = arrival_spec(vm);
+        if (given(vm, {"capture-load", "dispatch-load", "arrivals", "seed"}))
+            std::cout << "[args] Load model capture " << utils::to_string(capture) << ", dispatch " << utils::to_string(dispatch)
+                      << ", arrivals " << utils::to_string(arrivals.dist) << ", seed " << vm["seed"].as<std::uint64_t>() << "\n";
+    }
+    if (vm.count("copy-threads"))
+    {
+        if (auto ct = vm["copy-threads"].as<int>(); ct < -1 || ct > static_cast<int>(io::max_copy_threads))  //
+            throw std::out_of_range("--copy-threads argument is out of range");
+    }
+    if (vm.count("metrics-port"))
+    {
+        if (auto mp = vm["metrics-port"].as<int>(); mp < 0 || mp > 65535)  //
+            throw std::out_of_range("--metrics-port argument is out of range");
+    }
+    if (vm.count("trace-rate"))
+    {
+        if (auto tr = vm["trace-rate"].as<int>(); tr < 0)  //
+            throw std::out_of_range("--trace-rate argument is out of range");
+        if (auto tr = vm["trace-rate"].as<int>(); tr > 0)
+            std::cout << "[args] Tracing every " << tr << ". frame to " << vm["trace-file"].as<std::string>() << "\n";
+    }
+}
+
+/**
+ * Write the recorded trace events to a Chrome / Perfetto compatible JSON file
+ */
+static void write_trace(const std::string& file)
+{
+    auto os = std::ofstream{file};
+    if (!os)
+    {
+        std::cerr << "[trace] Failed to open " << file << "\n";
+        return;
+    }
+    auto cnt = utils::trace::dump(os);
+    std::cout << "[trace] Written " << cnt << " events to " << file << "\n";
+}
+
+/**
+ * Bring all frame memory into a deterministic state before the first real tick.
+ *
+ * Pre-fault every pooled frame and the i/o transfer buffer and optionally lock
+ * the memory into RAM.
+ */
+static void prepare_memory(cpc::frame_pool& pool, bool lock)
+{
+    for (auto& msg : pool.storage())
+    {
+        utils::prefault(&msg, sizeof(msg));
+    }
+    io::prefault();
+
+    if (lock && !utils::lock_memory())
+    {
+        std::cerr << "[warmup] Failed to lock memory, continue without (check RLIMIT_MEMLOCK)\n";
+    }
+}
+
+/**
+ * Pass some dummy frames through the running producers, the queue and the consumers
+ * to warm up caches, branch predictors and the wake-up paths of the threads.
+ *
+ * The simulated loads are skipped for these frames. Every lane has one frame in
+ * flight at a time, the next round starts after all of them are sent or dropped.
+ */
+static void warm_up(const std::vector<std::unique_ptr<producer::runnable>>& producers, int frames)
+{
+    auto& metrics  = cpc::metrics();
+    auto  done     = [&metrics]()
+    { return metrics.consumed.value() + metrics.dropped_pool.value() + metrics.dropped_queue.value() + metrics.dropped_corrupt.value(); };
+    auto  deadline = std::chrono::steady_clock::now() + 5s;
+    for (auto i = 0; i < frames; ++i)
+    {
+        for (auto& producer : producers)
+        {
+            producer->warm_up();
+        }
+        while (done() < static_cast<std::uint64_t>(i + 1) * producers.size())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                std::cerr << "[warmup] Dummy frames did not drain, continue without\n";
+                return;
+            }
+            std::this_thread::sleep_for(100us);
+        }
+    }
 }
 
 auto main(int argc, char* argv[]) -> int
@@ -61,6 +234,8 @@ auto main(int argc, char* argv[]) -> int
     //    program arguments variable map
     auto vm = po::variables_map{};
 
+    const auto startup_begin = std::chrono::steady_clock::now();
+
     try
     {
         auto ioc = boost::asio::io_context{};
@@ -78,6 +253,46 @@ auto main(int argc, char* argv[]) -> int
             "set the data processing rate between 10 and 1000 times per second");
         opt("runtime,r", po::value<int>()->default_value(min_runtime),  //
             "set the max program runtime to at least seconds");
+        opt("warmup,w", po::value<int>()->default_value(warmup_frames),  //
+            "set the number of dummy frames processed before the first tick");
+        opt("mlock",  //
+            "lock the pre-faulted frame memory into RAM");
+        opt("lanes,l", po::value<int>()->default_value(1),  //
+            "set the number of queue lanes, each fed by its own producer thread. Every producer ticks with --throughput, so "
+            "the offered load is lanes times the throughput");
+        opt("consumers,c", po::value<int>()->default_value(1),  //
+            "set the number of consumer threads");
+        opt("queue-size,q", po::value<int>()->default_value(queue_size),  //
+            "set the depth of every queue lane");
+        opt("wait", po::value<std::string>()->default_value("block"),  //
+            "set how consumers wait for frames, i.e. block, spin, spin-yield, spin-park");
+        opt("spin-budget", po::value<int>()->default_value(50),  //
+            "set the time in microseconds a consumer spins before it yields or parks");
+        opt("capture-load", po::value<std::string>()->default_value("none"),  //
+            "set the cost model of gathering a frame, i.e. none or <workload>:<distribution>:<mean us>[:<parameter>] with the "
+            "workloads cpu, memory, io and the distributions constant, normal, pareto, bursty. It shapes the cost only, see "
+            "--arrivals for the timing of the frames");
+        opt("dispatch-load", po::value<std::string>(),  //
+            "set the cost model of processing a frame, same format as --capture-load. Defaults to the load of the domain");
+        opt("arrivals", po::value<std::string>()->default_value("constant"),  //
+            "set the distribution of the gaps between two producer ticks around the tick period, i.e. "
+            "<distribution>[:<parameter>] with the distributions of --capture-load. Bursty arrivals come parameter times faster");
+        opt("seed", po::value<std::uint64_t>()->default_value(1),  //
+            "set the seed of the load models, equal seeds give equal costs per frame");
+        opt("integrity",  //
+            "seal every frame with a sequence number and checksum at capture and verify it before send");
+        opt("pin",  //
+            "pin every producer / consumer pair to a pair of cpu cores");
+        opt("copy-threads", po::value<int>()->default_value(-1),  //
+            "set the number of helper threads for parallel frame copies, -1 selects it by the number of cores");
+        opt("metrics-port", po::value<int>()->default_value(0),  //
+            "serve Prometheus metrics on http://<metrics-address>:<port>/metrics, 0 disables it");
+        opt("metrics-address", po::value<std::string>()->default_value("127.0.0.1"),  //
+            "set the local address the metrics listener binds to");
+        opt("trace-rate", po::value<int>()->default_value(0),  //
+            "trace every n-th frame, 0 disables tracing. Dump the trace with SIGUSR1 or at exit");
+        opt("trace-file", po::value<std::string>()->default_value("cpc.trace.json"),  //
+            "set the trace output file (Chrome trace event format)");
 
         // Parse the command line
         po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -102,6 +317,22 @@ auto main(int argc, char* argv[]) -> int
                 ioc.stop();
             });
 
+        //    Construct a signal set to dump the trace on demand
+        //
+        const auto trace_file   = vm["trace-file"].as<std::string>();
+        auto       trace_signal = boost::asio::signal_set{ioc, SIGUSR1};
+        auto       on_trace     = std::function<void(const boost::system::error_code&, int)>{};
+        on_trace                = [&trace_signal, &on_trace, &trace_file](const boost::system::error_code& ec, int)
+        {
+            if (!ec)
+            {
+                write_trace(trace_file);
+                trace_signal.async_wait(on_trace);
+            }
+        };
+        trace_signal.async_wait(on_trace);
+        utils::trace::set_sampling(static_cast<std::uint64_t>(vm["trace-rate"].as<int>()));
+
         //
         // 3) Program runtime observation
         //    Construct and start a deadline timer waiting for program timeout
@@ -113,32 +344,184 @@ auto main(int argc, char* argv[]) -> int
         // 4) Consumer / Producer
         //    start producing / consuming domain specific
         //
-        auto cp_queue = cpc::message_queue{};
+        if (auto ct = vm["copy-threads"].as<int>(); ct >= 0)
+        {
+            auto cfg    = io::copy_configuration();
+            cfg.threads = static_cast<unsigned>(ct);
+            io::configure_copy(cfg);
+        }
+        std::cout << "[io] Copy engine uses " << io::copy_isa() << " with " << io::copy_configuration().threads << " helper threads\n";
+
+        const auto lanes     = static_cast<size_t>(vm["lanes"].as<int>());
+        const auto consumers = static_cast<size_t>(vm["consumers"].as<int>());
+        const auto depth     = static_cast<size_t>(vm["queue-size"].as<int>());
+
+        auto frame_pool = cpc::frame_pool{cpc::pool_size(lanes, depth, consumers)};
+        auto wait       = utils::wait_strategy{utils::parse_wait_policy(vm["wait"].as<std::string>()),
+                                             std::chrono::microseconds{vm["spin-budget"].as<int>()}};
+        auto cp_queue   = cpc::message_queue{lanes, depth, consumers, wait};
+
+        const auto integrity = vm.count("integrity") > 0;
+        auto       checker   = cpc::integrity_checker{lanes};
+        auto       verify    = consumer::runnable::verify_t{};
+        if (integrity)
+        {
+            verify = [&checker](const cpc::message& msg) { return checker(msg); };
+        }
+
+        // capture, dispatch and the arrivals of every lane draw from independent streams of the same seed
+        const auto domain        = vm["domain"].as<std::string>();
+        const auto seed          = vm["seed"].as<std::uint64_t>();
+        const auto capture_load  = utils::load_model{utils::parse_load_spec(vm["capture-load"].as<std::string>()), seed};
+        const auto dispatch_load = utils::load_model{
+            utils::parse_load_spec(vm.count("dispatch-load") ? vm["dispatch-load"].as<std::string>() : default_dispatch_load(domain)), seed + 1};
+
+        auto consumer_runnables = std::vector<std::unique_ptr<consumer::runnable>>{};
+        auto consumer_runners   = std::vector<std::unique_ptr<utils::thread_runner>>{};
+        for (size_t worker = 0; worker < consumers; ++worker)
+        {
+            auto* r = consumer_runnables.emplace_back(std::make_unique<consumer::runnable>(cp_queue, worker, io::send_data, cpc::message_dispatcher<>{dispatch_load}, verify)).get();
+            consumer_runners.emplace_back(std::make_unique<utils::thread_runner>("consumer" + std::to_string(worker),  //
+                                                                                 [r]() { (*r)(); },                     //
+                                                                                 [r]() { r->abort(); }));
+        }
+
+        using frame_span = std::span<char, cpc::frame_size>;
+        auto emplace     = (domain == "video"sv)   ? [](cpc::frame& frame) -> frame_span { return frame.emplace<cpc::video_frame>(); }
+                           : (domain == "audio"sv) ? [](cpc::frame& frame) -> frame_span { return frame.emplace<cpc::audio_frame>(); }
+                           : (domain == "hw"sv)    ? [](cpc::frame& frame) -> frame_span { return frame.emplace<cpc::hw_frame>(); }
+                                                   : [](cpc::frame& frame) -> frame_span { return frame.emplace<cpc::network_frame>(); };
+        auto get_data    = [emplace, integrity, capture_load](cpc::message& msg)
+        {
+            auto frame = emplace(msg.payload);
+            if (integrity)
+            {
+                msg.tail.checksum = io::get_data_checked(frame);
+                msg.tail.sealed   = true;
+            }
+            else
+            {
+                io::get_data(frame);
+            }
+            if (!msg.warm_up)
+            {
+                capture_load.apply(msg.id, frame);
+            }
+        };
+
+        prepare_memory(frame_pool, vm.count("mlock") > 0);
 
-        auto consumer_runnable = consumer::runnable{cp_queue, io::send_data, cpc::message_dispatcher{}};
-        auto consumer          = utils::thread_runner{"consumer",                                       //
-                                             [&consumer_runnable]() { consumer_runnable(); },  //
-                                             [&consumer_runnable]() { consumer_runnable.abort(); }};
+        auto producer_runnables = std::vector<std::unique_ptr<producer::runnable>>{};
+        auto producer_runners   = std::vector<std::unique_ptr<utils::thread_runner>>{};
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            auto* r = producer_runnables
+                          .emplace_back(std::make_unique<producer::runnable>(ioc, cp_queue, lane, frame_pool, get_data,
+                                                                             producer::runnable::tick_t{1000 / vm["throughput"].as<int>()},
+                                                                             utils::load_model{arrival_spec(vm), seed + 2 + lane}))
+                          .get();
+            producer_runners.emplace_back(std::make_unique<utils::thread_runner>("producer" + std::to_string(lane),  //
+                                                                                 [r]() { (*r)(); },                     //
+                                                                                 [r]() { r->abort(); }));
+        }
 
-        auto domain   = vm["domain"].as<std::string>();
-        auto get_data = (domain == "video"sv)   ? [](cpc::frame& frame) { io::get_data(frame.emplace<cpc::video_frame>()); }
-                        : (domain == "audio"sv) ? [](cpc::frame& frame) { io::get_data(frame.emplace<cpc::audio_frame>()); }
-                        : (domain == "hw"sv)    ? [](cpc::frame& frame) { io::get_data(frame.emplace<cpc::hw_frame>()); }
-                                                : [](cpc::frame& frame) { io::get_data(frame.emplace<cpc::network_frame>()); };
+        //
+        // 5) Metrics
+        //    Sample the state of the queue and the pool at scrape time and serve them with the
+        //    counters of the data path on the io context. A scrape only reads atomics.
+        //
+        auto& registry = utils::metrics::default_registry();
+        registry.make_sampled_gauge("cpc_queue_depth", "frames waiting in the queue",  //
+                                    [&cp_queue]() { return static_cast<double>(cp_queue.size()); });
+        registry.make_sampled_gauge("cpc_frames_in_flight", "frames taken from the pool and not yet released",  //
+                                    [&frame_pool]() { return static_cast<double>(frame_pool.in_use()); });
+        registry.make_sampled_gauge("cpc_pool_utilization_ratio", "share of the frame pool in use",  //
+                                    [&frame_pool]()
+                                    { return static_cast<double>(frame_pool.in_use()) / static_cast<double>(frame_pool.capacity()); });
+        registry.make_sampled_counter("cpc_io_get_data_total", "frames gathered from the hardware",  //
+                                      []() { return static_cast<double>(io::transfers().get_data); });
+        registry.make_sampled_counter("cpc_io_send_data_total", "frames sent to the hardware",  //
+                                      []() { return static_cast<double>(io::transfers().send_data); });
+        if (integrity)
+        {
+            registry.make_sampled_counter("cpc_integrity_errors_total", "frames that failed the integrity check",  //
+                                          [&checker]() { return static_cast<double>(checker.corrupt()); }, {{"kind", "corrupt"}});
+            registry.make_sampled_counter("cpc_integrity_errors_total", "frames that failed the integrity check",  //
+                                          [&checker]() { return static_cast<double>(checker.missing()); }, {{"kind", "missing"}});
+            registry.make_sampled_counter("cpc_integrity_errors_total", "frames that failed the integrity check",  //
+                                          [&checker]() { return static_cast<double>(checker.reordered()); }, {{"kind", "reordered"}});
+            registry.make_sampled_counter("cpc_integrity_errors_total", "frames that failed the integrity check",  //
+                                          [&checker]() { return static_cast<double>(checker.duplicated()); }, {{"kind", "duplicated"}});
+        }
+        cpc::metrics();  // register the data path metrics, so they show up before the first frame
 
-        auto producer_runnable = producer::runnable{ioc, cp_queue, get_data, producer::runnable::tick_t{1000 / vm["throughput"].as<int>()}};
-        auto producer          = utils::thread_runner{"producer",                                       //
-                                             [&producer_runnable]() { producer_runnable(); },  //
-                                             [&producer_runnable]() { producer_runnable.abort(); }};
+        auto metrics_server = std::optional<utils::metrics::server>{};
+        if (auto port = vm["metrics-port"].as<int>(); port > 0)
+        {
+            metrics_server.emplace(ioc, registry, vm["metrics-address"].as<std::string>(), static_cast<unsigned short>(port));
+            std::cout << "[metrics] Serving on http://" << vm["metrics-address"].as<std::string>() << ":" << metrics_server->port()
+                      << "/metrics\n";
+        }
 
         //
-        // 5) start async event processing
+        // 6) start the threads, warm them up and start async event processing
         //
-        consumer.run();
-        producer.run();
+        if (vm.count("pin"))
+        {
+            // producer i and consumer i share a pair of neighboring cores, bound before they start
+            auto cores = std::max(1U, std::thread::hardware_concurrency());
+            for (size_t i = 0; i < producer_runners.size(); ++i)
+            {
+                producer_runners[i]->pin(static_cast<unsigned>(2 * i) % cores);
+            }
+            for (size_t i = 0; i < consumer_runners.size(); ++i)
+            {
+                consumer_runners[i]->pin(static_cast<unsigned>(2 * i + 1) % cores);
+            }
+        }
+        for (auto& consumer : consumer_runners)
+        {
+            consumer->run();
+        }
+        for (auto& producer : producer_runners)
+        {
+            producer->run();
+        }
+
+        // the dummy frames must not show up in the statistics
+        warm_up(producer_runnables, vm["warmup"].as<int>());
+        io::reset_statistics();
+        cpc::metrics().reset();
+        checker.reset_statistics();
+        utils::trace::clear();
+
+        auto pipeline_begin = std::chrono::steady_clock::now();
+        std::cout << "[main] Startup took "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(pipeline_begin - startup_begin).count() << "ms\n";
+        for (auto& producer : producer_runnables)
+        {
+            producer->start();
+        }
         ioc.run();
 
         io::print_statistics();
+        if (integrity)
+        {
+            checker.print_statistics();
+        }
+        if (vm["trace-rate"].as<int>() > 0)
+        {
+            write_trace(trace_file);
+        }
+        // from the capture to the send of the first frame, the startup is reported separately
+        if (cpc::metrics().consumed.value() == 0)
+        {
+            std::cout << "[main] First frame latency: n/a, no frame was sent\n";
+        }
+        else
+        {
+            std::cout << "[main] First frame latency: " << std::llround(cpc::metrics().first_frame.value() * 1e6) << "us\n";
+        }
     }
     catch (const std::exception& error)
     {
@@ -8,14 +8,28 @@
 
 #include <array>
 
+#include "cpc/metrics.hpp"
 #include "io/io.hpp"
+#include "utils/trace.hpp"
 
 namespace producer
 {
 
-runnable::runnable(io_context& ioc, mq_t& q, get_data_t gd, tick_t t)  //
-    : queue{q}, get_data{std::move(gd)}, expiry_time{t}, timer{ioc, t}
+runnable::runnable(io_context& ioc, mq_t& q, size_t l, pool_t& p, get_data_t gd, tick_t t, utils::load_model a)  //
+    : queue{q}, lane{l}, pool{p}, get_data{std::move(gd)}, expiry_time{t}, arrivals{a}, timer{ioc}
 {
+}
+
+auto runnable::warm_up() -> void
+{
+    warming.store(true, std::memory_order_relaxed);
+    trigger();
+}
+
+auto runnable::start() -> void
+{
+    trigger();
+    timer.expires_from_now(next_gap());
     timer.async_wait([this](const auto& ec) { tick(ec); });
 }
 
@@ -23,21 +37,46 @@ auto runnable::operator()() -> void
 {
     using namespace std::chrono_literals;
 
-    // copy io data into the transport frame
-    // and move it to the queue
-    auto frame_ptr = std::make_shared<cpc::frame>();
-
     // wait for a signal from the tick by attempting to decrement the semaphore
     tick_sync.acquire();
+    tick_pending.store(false, std::memory_order_release);
+    auto warm = warming.exchange(false, std::memory_order_relaxed);
 
-    get_data(*frame_ptr);
+    // copy io data into a preallocated transport frame
+    // and move it to the queue
+    // a dropped frame still takes its sequence, so the integrity check sees the gap
+    auto& metrics = cpc::metrics();
+    ++sequence;
+    auto msg = pool.acquire();
+    if (!msg)
+    {
+        metrics.dropped_pool.add();
+        throw std::runtime_error("Overload! frame pool exhausted");
+    }
+    msg->id      = lane + queue.lanes() * sequence;  // unique over all producers
+    msg->tail    = cpc::trailer{lane, sequence};
+    msg->warm_up = warm;
+
+    auto trace = utils::trace::scope{"produce", msg->id};
+    {
+        auto stage    = utils::trace::scope{"get_data"};
+        msg->captured = std::chrono::steady_clock::now();
+        get_data(*msg);
+    }
 
-    if (!queue.enqueue(std::move(frame_ptr)))
+    auto stage    = utils::trace::scope{"enqueue"};
+    auto enqueued = std::chrono::steady_clock::now();
+    metrics.get_data.observe(enqueued - msg->captured);
+    msg->enqueued = enqueued;
+    if (!queue.enqueue(lane, std::move(msg)))
     {
         // TODO
         // Think about a throttle mechanism to not overload the consumer
+        metrics.dropped_queue.add();
         throw std::runtime_error("Overload! failed to enqueue");
     }
+    metrics.enqueue.observe(std::chrono::steady_clock::now() - enqueued);
+    metrics.produced.add();
 }
 
 auto runnable::abort() -> void  //
@@ -49,11 +88,10 @@ void runnable::tick(const boost::system::error_code& ec)
 {
     if (!ec)
     {
-        // trigger runner to start work,
-        tick_sync.release();
+        trigger();
 
         // Reschedule the timer
-        timer.expires_at(timer.expires_at() + expiry_time);
+        timer.expires_at(timer.expires_at() + next_gap());
         timer.async_wait([this](const auto& ec) { tick(ec); });
     }
     else
@@ -62,4 +100,25 @@ void runnable::tick(const boost::system::error_code& ec)
         tick_sync.release();
     }
 }
+auto runnable::trigger() -> void
+{
+    // trigger runner to start work, unless it is still busy with the previous tick
+    if (tick_pending.exchange(true, std::memory_order_acq_rel))
+    {
+        cpc::metrics().tick_overruns.add();
+    }
+    else
+    {
+        tick_sync.release();
+    }
+}
+
+auto runnable::next_gap() -> boost::posix_time::time_duration
+{
+    if (arrivals.spec().mean.count() == 0)
+    {
+        return expiry_time;
+    }
+    return boost::posix_time::microseconds{arrivals.gap(++ticks).count() / 1000};
+}
 }  // namespace producer
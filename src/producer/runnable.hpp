@@ -6,12 +6,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <boost/asio/deadline_timer.hpp>
 #include <functional>
 #include <iostream>
 #include <span>
 
 #include "cpc/message_queue.hpp"
+#include "utils/load_model.hpp"
 
 namespace producer
 {
@@ -21,15 +23,29 @@ class runnable
     using io_context = boost::asio::io_context;
     using tick_t     = boost::posix_time::milliseconds;
     using mq_t       = cpc::message_queue;
-    using get_data_t = std::function<void(cpc::frame& output)>;
+    using pool_t     = cpc::frame_pool;
+    using get_data_t = std::function<void(cpc::message& output)>;
 
     /** construct a producer runnable
      * @param ioc   io context used to make the heartbeat of the runner using a deadline_timer
      * @param q     message queue, the runners synchronization point 
-     * @param gd    i/o interface for gathering data chunks from the hardware
+     * @param l     the lane of the queue this producer feeds exclusively
+     * @param p     pool of preallocated frames the data is gathered into
+     * @param gd    i/o interface for gathering data chunks from the hardware into the payload,
+     *              may seal the trailer with the checksum of the captured data
      * @param t     the rate of the heartbeate. This is the cycle with that we talk to the hardware
+     * @param a     model of the gaps between two ticks, the default keeps the fixed cycle t
      */
-    runnable(io_context& ioc, mq_t& q, get_data_t gd, tick_t t);
+    runnable(io_context& ioc, mq_t& q, size_t l, pool_t& p, get_data_t gd, tick_t t, utils::load_model a = {});
+
+    /** produce one dummy frame of the warm-up right away, with the simulated loads skipped.
+     * Call it before ::start() and only after the previous warm-up frame was taken.
+     */
+    auto warm_up() -> void;
+
+    /** start the heartbeat, the first frame is gathered right away
+     */
+    auto start() -> void;
 
     /** Wait for a tick and than start gathering data. 
      * 
@@ -41,12 +57,21 @@ class runnable
  
    private:
     void tick(const boost::system::error_code& ec);
+    auto trigger() -> void;
+    auto next_gap() -> boost::posix_time::time_duration;
 
     mq_t&                       queue;
+    size_t                      lane;
+    pool_t&                     pool;
     get_data_t                  get_data;
     tick_t                      expiry_time;
+    utils::load_model           arrivals;
+    std::uint64_t               ticks{0};
     boost::asio::deadline_timer timer;
-    std::binary_semaphore       tick_sync{1};
+    std::binary_semaphore       tick_sync{0};
+    std::atomic<bool>           tick_pending{false};  // a tick is signaled but not yet taken by the runner
+    std::atomic<bool>           warming{false};       // the pending tick is a warm-up frame
+    std::uint64_t               sequence{0};
 };
 }  // namespace producer
 
@@ -0,0 +1,288 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "utils/load_model.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace utils
+{
+namespace
+{
+using clock = std::chrono::steady_clock;
+
+constexpr size_t        cache_line   = 64;
+constexpr std::uint64_t burst_length = 8;
+constexpr double        burst_chance = 0.1;
+constexpr double        pareto_cap   = 100;
+
+constexpr double default_pareto_shape = 1.5;
+constexpr double default_burst_factor = 10;
+
+constexpr std::uint64_t lcg_mul = 6364136223846793005ULL;
+constexpr std::uint64_t lcg_inc = 1442695040888963407ULL;
+
+auto sink = std::atomic<std::uint64_t>{0};  // keeps the results of the busy loops alive
+
+/** splitmix64 finalizer, a cheap but well mixing bijection
+ */
+constexpr auto mix(std::uint64_t x) -> std::uint64_t
+{
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/** uniform random number in (0, 1], derived from seed, frame id and the draw number only
+ */
+auto uniform(std::uint64_t seed, std::uint64_t id, std::uint64_t draw) -> double
+{
+    constexpr auto mantissa = 0x1.0p-53;
+    auto           x        = mix(seed ^ mix(id * 0x9E3779B97F4A7C15ULL + draw));
+    return (static_cast<double>(x >> 11) + 1.0) * mantissa;
+}
+
+auto burn_cpu(std::uint64_t frame_id, clock::time_point deadline) -> void
+{
+    auto x = frame_id | 1;
+    do
+    {
+        for (auto i = 0; i < 1024; ++i)
+        {
+            x = x * lcg_mul + lcg_inc;
+            x ^= x >> 29;
+        }
+    } while (clock::now() < deadline);
+    sink.store(x, std::memory_order_relaxed);
+}
+
+auto touch_memory(std::uint64_t frame_id, std::span<const char> data, clock::time_point deadline) -> void
+{
+    // every read depends on the previous one, so neither the out of order
+    // execution nor the hardware prefetcher can hide the memory latency
+    const auto lines = data.size() / cache_line;
+    auto       x     = mix(frame_id);
+    auto       sum   = std::uint64_t{0};
+    do
+    {
+        for (auto i = 0; i < 64; ++i)
+        {
+            auto v = static_cast<unsigned char>(data[(x >> 24) % lines * cache_line]);
+            x      = x * lcg_mul + lcg_inc + v;
+            sum += v;
+        }
+    } while (clock::now() < deadline);
+    sink.store(sum, std::memory_order_relaxed);
+}
+
+auto split(std::string_view s, char delimiter) -> std::vector<std::string_view>
+{
+    auto fields = std::vector<std::string_view>{};
+    for (auto pos = s.find(delimiter); pos != std::string_view::npos; pos = s.find(delimiter))
+    {
+        fields.push_back(s.substr(0, pos));
+        s.remove_prefix(pos + 1);
+    }
+    fields.push_back(s);
+    return fields;
+}
+
+template <typename T>
+auto parse_number(std::string_view s) -> T
+{
+    auto value     = T{};
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+    if (ec != std::errc{} || ptr != s.data() + s.size())
+    {
+        throw std::invalid_argument("invalid number in load spec");
+    }
+    return value;
+}
+
+}  // namespace
+
+auto to_string(workload w) -> std::string_view
+{
+    switch (w)
+    {
+        case workload::none: return "none";
+        case workload::cpu: return "cpu";
+        case workload::memory: return "memory";
+        case workload::io: return "io";
+    }
+    return "unknown";
+}
+
+auto to_string(cost_distribution d) -> std::string_view
+{
+    switch (d)
+    {
+        case cost_distribution::constant: return "constant";
+        case cost_distribution::normal: return "normal";
+        case cost_distribution::pareto: return "pareto";
+        case cost_distribution::bursty: return "bursty";
+    }
+    return "unknown";
+}
+
+auto to_string(const load_spec& spec) -> std::string
+{
+    if (spec.work == workload::none)
+    {
+        return "none";
+    }
+    auto s = std::string{to_string(spec.work)};
+    s += ':';
+    s += to_string(spec.dist);
+    s += ':';
+    s += std::to_string(spec.mean.count());
+    if (spec.parameter != 0)
+    {
+        auto buffer    = std::array<char, 32>{};
+        auto [ptr, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), spec.parameter);
+        s += ':';
+        s.append(buffer.data(), ptr);
+    }
+    return s;
+}
+
+auto parse_load_spec(std::string_view s) -> load_spec
+{
+    if (s == to_string(workload::none))
+    {
+        return {};
+    }
+
+    auto fields = split(s, ':');
+    if (fields.size() < 3 || fields.size() > 4)
+    {
+        throw std::invalid_argument("load spec must be <workload>:<distribution>:<mean us>[:<parameter>]");
+    }
+
+    auto spec = load_spec{};
+    for (auto w : {workload::cpu, workload::memory, workload::io})
+    {
+        if (fields[0] == to_string(w))
+        {
+            spec.work = w;
+        }
+    }
+    for (auto d : {cost_distribution::constant, cost_distribution::normal, cost_distribution::pareto, cost_distribution::bursty})
+    {
+        if (fields[1] == to_string(d))
+        {
+            spec.dist = d;
+        }
+    }
+    if (spec.work == workload::none || to_string(spec.dist) != fields[1])
+    {
+        throw std::invalid_argument("unknown workload or cost distribution in load spec");
+    }
+
+    spec.mean      = std::chrono::microseconds{parse_number<std::int64_t>(fields[2])};
+    spec.parameter = fields.size() > 3 ? parse_number<double>(fields[3]) : 0;
+    if (spec.mean.count() < 0 || spec.parameter < 0 || (spec.dist == cost_distribution::pareto && spec.parameter != 0 && spec.parameter <= 1))
+    {
+        throw std::invalid_argument("load spec out of range");
+    }
+    return spec;
+}
+
+load_model::load_model(load_spec spec, std::uint64_t seed)  //
+    : settings{spec}, seed{mix(seed)}
+{
+}
+
+auto load_model::cost(std::uint64_t frame_id) const -> std::chrono::nanoseconds
+{
+    const auto mean = static_cast<double>(std::chrono::nanoseconds{settings.mean}.count());
+    auto       cost = mean;
+    switch (settings.dist)
+    {
+        case cost_distribution::constant: break;
+        case cost_distribution::normal:
+        {
+            // Box-Muller, std::normal_distribution is not reproducible across standard libraries
+            auto sigma = settings.parameter > 0 ? settings.parameter * 1000 : mean / 4;
+            auto z     = std::sqrt(-2 * std::log(uniform(seed, frame_id, 0))) * std::cos(2 * std::numbers::pi * uniform(seed, frame_id, 1));
+            cost       = std::max(0.0, mean + sigma * z);
+            break;
+        }
+        case cost_distribution::pareto:
+        {
+            auto shape = settings.parameter > 0 ? settings.parameter : default_pareto_shape;
+            auto scale = mean * (shape - 1) / shape;  // so that the mean of the distribution is the configured one
+            cost       = std::min(scale / std::pow(uniform(seed, frame_id, 0), 1 / shape), pareto_cap * mean);
+            break;
+        }
+        case cost_distribution::bursty:
+        {
+            // all frames of a run share one draw, so bursts hit consecutive frames
+            auto factor = settings.parameter > 0 ? settings.parameter : default_burst_factor;
+            if (uniform(seed, frame_id / burst_length, 2) <= burst_chance)
+            {
+                cost *= factor;
+            }
+            break;
+        }
+    }
+    return std::chrono::nanoseconds{std::llround(cost)};
+}
+
+auto load_model::gap(std::uint64_t n) const -> std::chrono::nanoseconds
+{
+    if (settings.dist != cost_distribution::bursty)
+    {
+        return cost(n);
+    }
+    auto factor = settings.parameter > 0 ? settings.parameter : default_burst_factor;
+    auto gap    = static_cast<double>(std::chrono::nanoseconds{settings.mean}.count());
+    if (uniform(seed, n / burst_length, 2) <= burst_chance)
+    {
+        gap /= factor;
+    }
+    return std::chrono::nanoseconds{std::llround(gap)};
+}
+
+auto load_model::apply(std::uint64_t frame_id, std::span<const char> data) const -> void
+{
+    if (settings.work == workload::none)
+    {
+        return;
+    }
+    auto duration = cost(frame_id);
+    if (duration <= std::chrono::nanoseconds::zero())
+    {
+        return;
+    }
+
+    switch (settings.work)
+    {
+        case workload::none: break;
+        case workload::io: std::this_thread::sleep_for(duration); break;
+        case workload::cpu: burn_cpu(frame_id, clock::now() + duration); break;
+        case workload::memory:
+            if (data.size() < cache_line)
+            {
+                burn_cpu(frame_id, clock::now() + duration);
+            }
+            else
+            {
+                touch_memory(frame_id, data, clock::now() + duration);
+            }
+            break;
+    }
+}
+
+}  // namespace utils
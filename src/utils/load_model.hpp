@@ -0,0 +1,87 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace utils
+{
+
+/** what a simulated processing step spends its time with
+ */
+enum class workload
+{
+    none,    // no load at all
+    cpu,     // busy computation, occupies a core
+    memory,  // dependent random reads of the frame, bound by the memory latency
+    io,      // blocking wait for a device, leaves the core idle
+};
+
+/** how the cost varies from frame to frame
+ */
+enum class cost_distribution
+{
+    constant,  // every frame costs the mean
+    normal,    // gaussian around the mean, parameter is the standard deviation in us (default mean / 4)
+    pareto,    // heavy tailed with the given mean, parameter is the shape > 1 (default 1.5), capped at 100 times the mean
+    bursty,    // runs of 8 frames become a burst with a chance of 10%, a burst costs parameter (default 10) times the mean
+};
+
+struct load_spec
+{
+    workload                  work      = workload::none;
+    cost_distribution         dist      = cost_distribution::constant;
+    std::chrono::microseconds mean      = {};
+    double                    parameter = 0;  // 0 selects the default of the distribution
+};
+
+auto to_string(workload w) -> std::string_view;
+auto to_string(cost_distribution d) -> std::string_view;
+auto to_string(const load_spec& spec) -> std::string;
+
+/** parse "none" or "<workload>:<distribution>:<mean us>[:<parameter>]", e.g. "cpu:normal:5000:1000"
+ * @throw std::invalid_argument on a malformed spec
+ */
+auto parse_load_spec(std::string_view s) -> load_spec;
+
+/** Deterministic load generator for the simulated hardware and processing.
+ *
+ * The cost of a frame is a pure function of the seed and the frame id. So a
+ * run is reproducible no matter which thread processes a frame, and the
+ * model can be shared by any number of threads without synchronization.
+ */
+class load_model
+{
+   public:
+    load_model() = default;
+    load_model(load_spec spec, std::uint64_t seed);
+
+    /** @return the time processing the given frame shall take
+     */
+    [[nodiscard]] auto cost(std::uint64_t frame_id) const -> std::chrono::nanoseconds;
+
+    /** @return the time between the arrivals of the tick n - 1 and n, drawn like the cost. Bursty
+     * arrivals come parameter times faster within a burst instead of costing more.
+     */
+    [[nodiscard]] auto gap(std::uint64_t n) const -> std::chrono::nanoseconds;
+
+    /** spend the cost of the given frame with the configured workload, memory workloads read from data
+     */
+    auto apply(std::uint64_t frame_id, std::span<const char> data) const -> void;
+
+    [[nodiscard]] auto spec() const -> const load_spec& { return settings; }
+
+   private:
+    load_spec     settings;
+    std::uint64_t seed{0};
+};
+
+}  // namespace utils
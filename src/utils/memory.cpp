@@ -0,0 +1,37 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "utils/memory.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace utils
+{
+
+auto prefault(void* mem, size_t size) -> void
+{
+    static const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    // read and write back one byte per page. The write is required, a read
+    // alone would just map the shared zero page.
+    auto* bytes = static_cast<volatile char*>(mem);
+    for (size_t i = 0; i < size; i += page_size)
+    {
+        bytes[i] = bytes[i];
+    }
+    if (size > 0)
+    {
+        bytes[size - 1] = bytes[size - 1];
+    }
+}
+
+auto lock_memory() -> bool  //
+{
+    return mlockall(MCL_CURRENT) == 0;
+}
+
+}  // namespace utils
@@ -0,0 +1,24 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace utils
+{
+
+/** touch every page of the given memory range, so later accesses do not page-fault.
+ * The content of the memory is left unchanged.
+ */
+auto prefault(void* mem, size_t size) -> void;
+
+/** lock all currently mapped pages of the process into RAM (mlockall)
+ * @return false if the pages could not be locked, e.g. due to RLIMIT_MEMLOCK
+ */
+auto lock_memory() -> bool;
+
+}  // namespace utils
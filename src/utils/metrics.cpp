@@ -0,0 +1,329 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "utils/metrics.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+#include <string_view>
+
+namespace utils::metrics
+{
+namespace
+{
+/** every thread gets its own shard index, handed out round robin
+ */
+auto this_shard() -> size_t
+{
+    static auto             next  = std::atomic<size_t>{0};
+    thread_local const auto shard = next.fetch_add(1, std::memory_order_relaxed);
+    return shard;
+}
+
+auto format_value(double v) -> std::string
+{
+    if (std::isnan(v))
+    {
+        return "NaN";
+    }
+    if (std::isinf(v))
+    {
+        return v > 0 ? "+Inf" : "-Inf";
+    }
+    auto buffer    = std::array<char, 32>{};
+    auto [ptr, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), v);
+    return std::string(buffer.data(), ptr);
+}
+
+auto escape(std::string_view s, bool quote) -> std::string
+{
+    auto out = std::string{};
+    out.reserve(s.size());
+    for (auto c : s)
+    {
+        switch (c)
+        {
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '"': out += quote ? "\\\"" : "\""; break;
+            default: out += c;
+        }
+    }
+    return out;
+}
+
+/** render the labels as name="value" pairs, without the braces
+ */
+auto render(const labels& l) -> std::string
+{
+    auto out = std::string{};
+    for (const auto& [name, value] : l)
+    {
+        if (!out.empty())
+        {
+            out += ",";
+        }
+        out += name + "=\"" + escape(value, true) + "\"";
+    }
+    return out;
+}
+
+auto braced(const std::string& label_set) -> std::string  //
+{
+    return label_set.empty() ? std::string{} : "{" + label_set + "}";
+}
+
+}  // namespace
+
+auto latency_buckets() -> const std::vector<double>&
+{
+    static const auto bounds = std::vector<double>{25e-6, 50e-6, 100e-6, 250e-6, 500e-6, 1e-3, 2.5e-3, 5e-3,
+                                                   10e-3, 25e-3, 50e-3,  100e-3, 250e-3, 500e-3, 1};
+    return bounds;
+}
+
+auto counter::add(std::uint64_t n) -> void  //
+{
+    slots[this_shard() % shards].value.fetch_add(n, std::memory_order_relaxed);
+}
+
+auto counter::value() const -> std::uint64_t
+{
+    auto sum = std::uint64_t{0};
+    for (const auto& s : slots)
+    {
+        sum += s.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+auto counter::reset() -> void
+{
+    for (auto& s : slots)
+    {
+        s.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+histogram::histogram(std::vector<double> bounds)  //
+    : upper{std::move(bounds)},
+      lines_per_shard{(upper.size() + per_line) / per_line},
+      lines{std::make_unique<line[]>(shards * lines_per_shard)}
+{
+    if (!std::is_sorted(upper.begin(), upper.end()))
+    {
+        throw std::invalid_argument("histogram bounds must be ascending");
+    }
+}
+
+auto histogram::observe(double v) -> void
+{
+    // the bucket bounds are inclusive, "le" in Prometheus terms
+    auto bucket = static_cast<size_t>(std::lower_bound(upper.begin(), upper.end(), v) - upper.begin());
+    auto shard  = this_shard() % shards;
+    count(shard, bucket).fetch_add(1, std::memory_order_relaxed);
+    sums[shard].value.fetch_add(v, std::memory_order_relaxed);
+}
+
+auto histogram::buckets() const -> std::vector<std::uint64_t>
+{
+    auto out = std::vector<std::uint64_t>(upper.size() + 1);
+    for (size_t shard = 0; shard < shards; ++shard)
+    {
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            out[i] += count(shard, i).load(std::memory_order_relaxed);
+        }
+    }
+    return out;
+}
+
+auto histogram::sum() const -> double
+{
+    auto total = 0.0;
+    for (const auto& s : sums)
+    {
+        total += s.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+auto histogram::reset() -> void
+{
+    for (size_t i = 0; i < shards * lines_per_shard; ++i)
+    {
+        for (auto& c : lines[i].counts)
+        {
+            c.store(0, std::memory_order_relaxed);
+        }
+    }
+    for (auto& s : sums)
+    {
+        s.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+auto histogram::count(size_t shard, size_t bucket) const -> std::atomic<std::uint64_t>&
+{
+    return lines[shard * lines_per_shard + bucket / per_line].counts[bucket % per_line];
+}
+
+struct registry::series
+{
+    std::string                label_set;
+    std::unique_ptr<counter>   c;
+    std::unique_ptr<gauge>     g;
+    std::unique_ptr<histogram> h;
+    sample_fn                  sample;
+};
+
+struct registry::family
+{
+    std::string                          name;
+    std::string                          help;
+    const char*                          type;
+    std::vector<std::unique_ptr<series>> members;
+};
+
+registry::registry()  = default;
+registry::~registry() = default;
+
+auto registry::find_or_add(const std::string& name, const std::string& help, const char* type, const labels& l) -> series&
+{
+    auto it = std::find_if(families.begin(), families.end(), [&name](const auto& f) { return f->name == name; });
+    if (it == families.end())
+    {
+        families.push_back(std::make_unique<family>(family{name, help, type, {}}));
+        it = std::prev(families.end());
+    }
+    if (std::string_view{(*it)->type} != type)
+    {
+        throw std::invalid_argument("metric " + name + " is already registered with another type");
+    }
+
+    auto& members   = (*it)->members;
+    auto  label_set = render(l);
+    auto  s = std::find_if(members.begin(), members.end(), [&label_set](const auto& m) { return m->label_set == label_set; });
+    if (s == members.end())
+    {
+        members.push_back(std::make_unique<series>(series{label_set, {}, {}, {}, {}}));
+        s = std::prev(members.end());
+    }
+    return **s;
+}
+
+auto registry::make_counter(const std::string& name, const std::string& help, const labels& l) -> counter&
+{
+    auto  guard = std::lock_guard<std::mutex>{registration};
+    auto& s     = find_or_add(name, help, "counter", l);
+    if (s.sample)
+    {
+        throw std::invalid_argument("metric " + name + " is already registered as sampled counter");
+    }
+    if (!s.c)
+    {
+        s.c = std::make_unique<counter>();
+    }
+    return *s.c;
+}
+
+auto registry::make_gauge(const std::string& name, const std::string& help, const labels& l) -> gauge&
+{
+    auto  guard = std::lock_guard<std::mutex>{registration};
+    auto& s     = find_or_add(name, help, "gauge", l);
+    if (s.sample)
+    {
+        throw std::invalid_argument("metric " + name + " is already registered as sampled gauge");
+    }
+    if (!s.g)
+    {
+        s.g = std::make_unique<gauge>();
+    }
+    return *s.g;
+}
+
+auto registry::make_histogram(const std::string& name, const std::string& help, const labels& l, std::vector<double> bounds) -> histogram&
+{
+    auto  guard = std::lock_guard<std::mutex>{registration};
+    auto& s     = find_or_add(name, help, "histogram", l);
+    if (!s.h)
+    {
+        s.h = std::make_unique<histogram>(std::move(bounds));
+    }
+    return *s.h;
+}
+
+auto registry::make_sampled_counter(const std::string& name, const std::string& help, sample_fn fn, const labels& l) -> void
+{
+    auto  guard = std::lock_guard<std::mutex>{registration};
+    auto& s     = find_or_add(name, help, "counter", l);
+    if (s.c)
+    {
+        throw std::invalid_argument("metric " + name + " is already registered as counter");
+    }
+    s.sample = std::move(fn);
+}
+
+auto registry::make_sampled_gauge(const std::string& name, const std::string& help, sample_fn fn, const labels& l) -> void
+{
+    auto  guard = std::lock_guard<std::mutex>{registration};
+    auto& s     = find_or_add(name, help, "gauge", l);
+    if (s.g)
+    {
+        throw std::invalid_argument("metric " + name + " is already registered as gauge");
+    }
+    s.sample = std::move(fn);
+}
+
+auto registry::write(std::ostream& os) const -> void
+{
+    // the lock only serializes against registrations, the metrics are read without any lock
+    auto guard = std::lock_guard<std::mutex>{registration};
+    for (const auto& f : families)
+    {
+        os << "# HELP " << f->name << " " << escape(f->help, false) << "\n";
+        os << "# TYPE " << f->name << " " << f->type << "\n";
+        for (const auto& s : f->members)
+        {
+            if (s->h)
+            {
+                auto counts     = s->h->buckets();
+                auto cumulative = std::uint64_t{0};
+                auto separator  = s->label_set.empty() ? "" : ",";
+                for (size_t i = 0; i < counts.size(); ++i)
+                {
+                    cumulative += counts[i];
+                    auto le = i < s->h->bounds().size() ? format_value(s->h->bounds()[i]) : "+Inf";
+                    os << f->name << "_bucket{" << s->label_set << separator << "le=\"" << le << "\"} " << cumulative << "\n";
+                }
+                os << f->name << "_sum" << braced(s->label_set) << " " << format_value(s->h->sum()) << "\n";
+                os << f->name << "_count" << braced(s->label_set) << " " << cumulative << "\n";
+            }
+            else if (s->c)
+            {
+                os << f->name << braced(s->label_set) << " " << s->c->value() << "\n";
+            }
+            else if (s->g)
+            {
+                os << f->name << braced(s->label_set) << " " << format_value(s->g->value()) << "\n";
+            }
+            else if (s->sample)
+            {
+                os << f->name << braced(s->label_set) << " " << format_value(s->sample()) << "\n";
+            }
+        }
+    }
+}
+
+auto default_registry() -> registry&
+{
+    static auto r = registry{};
+    return r;
+}
+
+}  // namespace utils::metrics
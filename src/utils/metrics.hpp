@@ -0,0 +1,167 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace utils::metrics
+{
+/** label name / value pairs of a metric, e.g. {{"stage", "dispatch"}} */
+using labels = std::vector<std::pair<std::string, std::string>>;
+
+/** upper bounds in seconds of the default latency histogram buckets */
+auto latency_buckets() -> const std::vector<double>&;
+
+/** metrics written on the data path are spread over this many cache lines, a thread writes to one of them */
+constexpr size_t shards     = 16;
+constexpr size_t cache_line = 64;
+
+/** Monotonic counter.
+ *
+ * Sharded over a few cache lines, every thread adds to its own shard. So
+ * concurrent writers do not bounce a cache line between their cores. Reading
+ * sums up all shards.
+ */
+class counter
+{
+   public:
+    auto add(std::uint64_t n = 1) -> void;
+
+    [[nodiscard]] auto value() const -> std::uint64_t;
+
+    auto reset() -> void;
+
+   private:
+    struct alignas(cache_line) shard
+    {
+        std::atomic<std::uint64_t> value{0};
+    };
+    std::array<shard, shards> slots;
+};
+
+/** value that can go up and down
+ */
+class gauge
+{
+   public:
+    auto set(double v) -> void { current.store(v, std::memory_order_relaxed); }
+    auto add(double v) -> void { current.fetch_add(v, std::memory_order_relaxed); }
+
+    [[nodiscard]] auto value() const -> double { return current.load(std::memory_order_relaxed); }
+
+   private:
+    std::atomic<double> current{0};
+};
+
+/** Distribution of observed values in fixed buckets.
+ *
+ * Observing is lock-free, one atomic increment of the bucket and one of the sum.
+ * Buckets and sum are sharded like the counter, so concurrent observers do not
+ * share a cache line. Reading sums up all shards.
+ */
+class histogram
+{
+   public:
+    /** @param bounds ascending upper bounds of the buckets, an implicit +Inf bucket is added */
+    explicit histogram(std::vector<double> bounds);
+
+    auto observe(double v) -> void;
+    auto observe(std::chrono::nanoseconds d) -> void { observe(std::chrono::duration<double>{d}.count()); }
+
+    [[nodiscard]] auto bounds() const -> const std::vector<double>& { return upper; }
+
+    /** number of observations per bucket, not cumulated, the last one is the +Inf bucket */
+    [[nodiscard]] auto buckets() const -> std::vector<std::uint64_t>;
+
+    [[nodiscard]] auto sum() const -> double;
+
+    auto reset() -> void;
+
+   private:
+    static constexpr size_t per_line = cache_line / sizeof(std::uint64_t);
+
+    struct alignas(cache_line) line
+    {
+        std::array<std::atomic<std::uint64_t>, per_line> counts{};
+    };
+    struct alignas(cache_line) shard_sum
+    {
+        std::atomic<double> value{0};
+    };
+
+    auto count(size_t shard, size_t bucket) const -> std::atomic<std::uint64_t>&;
+
+    std::vector<double>           upper;
+    size_t                        lines_per_shard;  // the buckets of a shard, rounded up to whole cache lines
+    std::unique_ptr<line[]>       lines;
+    std::array<shard_sum, shards> sums;
+};
+
+/** Named collection of metrics, written in the Prometheus text exposition format.
+ *
+ * Registering takes a lock and is meant for the startup. The returned
+ * references stay valid for the lifetime of the registry. Registering the
+ * same name and labels again returns the existing metric. Writing never
+ * touches a lock of the data path, it only reads the atomics of the metrics
+ * or calls the sampling functions.
+ */
+class registry
+{
+   public:
+    using sample_fn = std::function<double()>;
+
+    registry();
+
+    registry(const registry& other) = delete;
+    auto operator=(const registry& rhs) -> registry& = delete;
+
+    registry(registry&& rhs) noexcept = delete;
+    auto operator=(registry&& rhs) noexcept -> registry& = delete;
+
+    ~registry();
+
+    auto make_counter(const std::string& name, const std::string& help, const labels& l = {}) -> counter&;
+    auto make_gauge(const std::string& name, const std::string& help, const labels& l = {}) -> gauge&;
+    auto make_histogram(const std::string& name, const std::string& help, const labels& l = {},
+                        std::vector<double> bounds = latency_buckets()) -> histogram&;
+
+    /** counter or gauge whose value is sampled when the registry is written, e.g. the size of a queue.
+     * The function must be cheap, thread safe and must not block.
+     */
+    auto make_sampled_counter(const std::string& name, const std::string& help, sample_fn fn, const labels& l = {}) -> void;
+    auto make_sampled_gauge(const std::string& name, const std::string& help, sample_fn fn, const labels& l = {}) -> void;
+
+    /** write all metrics in the Prometheus text format (version 0.0.4)
+     */
+    auto write(std::ostream& os) const -> void;
+
+   private:
+    struct series;
+    struct family;
+
+    auto find_or_add(const std::string& name, const std::string& help, const char* type, const labels& l) -> series&;
+
+    mutable std::mutex                   registration;
+    std::vector<std::unique_ptr<family>> families;
+};
+
+/** registry shared by all modules of the process
+ */
+auto default_registry() -> registry&;
+
+}  // namespace utils::metrics
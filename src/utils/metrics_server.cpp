@@ -0,0 +1,129 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "utils/metrics_server.hpp"
+
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+#include <memory>
+#include <sstream>
+
+namespace utils::metrics
+{
+namespace
+{
+using boost::asio::ip::tcp;
+
+constexpr size_t max_request_size = 8192;
+
+/** one scrape, lives as long as one of its asynchronous operations is pending
+ */
+struct session : std::enable_shared_from_this<session>
+{
+    session(tcp::socket s, const registry& r) : socket{std::move(s)}, reg{r}, deadline{socket.get_executor()} {}
+
+    auto start(std::chrono::steady_clock::duration timeout) -> void
+    {
+        // closing the socket cancels the pending read or write
+        deadline.expires_after(timeout);
+        deadline.async_wait(
+            [self = shared_from_this()](const boost::system::error_code& ec)
+            {
+                if (!ec)
+                {
+                    auto ignored = boost::system::error_code{};
+                    self->socket.close(ignored);
+                }
+            });
+
+        boost::asio::async_read_until(socket, request, "\r\n\r\n",
+                                      [self = shared_from_this()](const boost::system::error_code& ec, size_t) { self->respond(ec); });
+    }
+
+    auto respond(const boost::system::error_code& ec) -> void
+    {
+        if (ec)
+        {
+            deadline.cancel();
+            return;
+        }
+
+        auto is     = std::istream{&request};
+        auto method = std::string{};
+        auto target = std::string{};
+        is >> method >> target;
+
+        auto body   = std::ostringstream{};
+        auto status = "200 OK";
+        if (method == "GET" && (target == "/metrics" || target == "/"))
+        {
+            reg.write(body);
+        }
+        else
+        {
+            status = "404 Not Found";
+            body << "not found\n";
+        }
+
+        auto payload = body.str();
+        auto os      = std::ostringstream{};
+        os << "HTTP/1.1 " << status << "\r\n"
+           << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+           << "Content-Length: " << payload.size() << "\r\n"
+           << "Connection: close\r\n\r\n"
+           << payload;
+        response = os.str();
+
+        boost::asio::async_write(socket, boost::asio::buffer(response),
+                                 [self = shared_from_this()](const boost::system::error_code&, size_t)
+                                 {
+                                     auto ignored = boost::system::error_code{};
+                                     self->socket.shutdown(tcp::socket::shutdown_both, ignored);
+                                     self->deadline.cancel();
+                                 });
+    }
+
+    tcp::socket               socket;
+    const registry&           reg;
+    boost::asio::steady_timer deadline;
+    boost::asio::streambuf    request{max_request_size};
+    std::string               response;
+};
+
+}  // namespace
+
+server::server(boost::asio::io_context& ioc, const registry& r, const std::string& address, unsigned short port,
+               std::chrono::steady_clock::duration timeout)
+    : registry_ref{r}, timeout{timeout}, acceptor{ioc, tcp::endpoint{boost::asio::ip::make_address(address), port}}
+{
+    accept();
+}
+
+auto server::port() const -> unsigned short  //
+{
+    return acceptor.local_endpoint().port();
+}
+
+auto server::accept() -> void
+{
+    acceptor.async_accept(
+        [this](const boost::system::error_code& ec, tcp::socket socket)
+        {
+            if (ec == boost::asio::error::operation_aborted)
+            {
+                return;
+            }
+            if (!ec)
+            {
+                std::make_shared<session>(std::move(socket), registry_ref)->start(timeout);
+            }
+            accept();
+        });
+}
+
+}  // namespace utils::metrics
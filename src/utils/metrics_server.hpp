@@ -0,0 +1,58 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <chrono>
+#include <string>
+
+#include "utils/metrics.hpp"
+
+namespace utils::metrics
+{
+
+/** Minimal HTTP listener that serves a registry for Prometheus scrapes.
+ *
+ * Runs completely asynchronous on the given io_context. Every connection
+ * gets the metrics of GET /metrics and is closed afterwards, anything else
+ * is answered with 404. A connection that does not complete its scrape
+ * within the timeout is closed, so idle clients cannot pile up.
+ */
+class server
+{
+   public:
+    /**
+     * @param ioc      context the listener runs on
+     * @param r        registry to serve, has to outlive the server
+     * @param address  local address to bind to
+     * @param port     tcp port, 0 selects a free one
+     * @param timeout  deadline of a connection from accept to the sent response
+     */
+    server(boost::asio::io_context& ioc, const registry& r, const std::string& address, unsigned short port,
+           std::chrono::steady_clock::duration timeout = std::chrono::seconds{5});
+
+    server(const server& other) = delete;
+    auto operator=(const server& rhs) -> server& = delete;
+
+    server(server&& rhs) noexcept = delete;
+    auto operator=(server&& rhs) noexcept -> server& = delete;
+
+    ~server() = default;
+
+    /** @return the port the server listens on */
+    [[nodiscard]] auto port() const -> unsigned short;
+
+   private:
+    auto accept() -> void;
+
+    const registry&                     registry_ref;
+    std::chrono::steady_clock::duration timeout;
+    boost::asio::ip::tcp::acceptor      acceptor;
+};
+
+}  // namespace utils::metrics
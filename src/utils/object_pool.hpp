@@ -0,0 +1,115 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace utils
+{
+
+/** Fixed size pool of preallocated objects.
+ *
+ * All objects are allocated once at construction time, so their memory can be
+ * pre-faulted (and locked) before the first real work item arrives. Objects are
+ * handed out as shared pointers that return to the pool when the last owner drops them.
+ * The pool has to outlive every object it has handed out.
+ */
+template <typename T>
+class object_pool
+{
+   public:
+    using obj     = T;
+    using obj_ptr = std::shared_ptr<obj>;
+
+    explicit object_pool(size_t capacity);
+
+    object_pool(const object_pool& other) = delete;
+    auto operator=(const object_pool& rhs) -> object_pool& = delete;
+
+    object_pool(object_pool&& rhs) noexcept = delete;
+    auto operator=(object_pool&& rhs) noexcept -> object_pool& = delete;
+
+    ~object_pool() = default;
+
+    /** take an object out of the pool
+     * @return nullptr if the pool is exhausted
+     */
+    [[nodiscard]] auto acquire() -> obj_ptr;
+
+    /** number of objects currently available in the pool
+     */
+    auto available() -> size_t;
+
+    [[nodiscard]] auto capacity() const -> size_t { return slots.size(); }
+
+    /** number of objects currently handed out, lock-free, e.g. for monitoring
+     */
+    [[nodiscard]] auto in_use() const -> size_t { return used.load(std::memory_order_relaxed); }
+
+    /** access to the whole backing store, e.g. to pre-fault its memory
+     */
+    [[nodiscard]] auto storage() -> std::span<obj> { return slots; }
+
+   private:
+    auto release(obj* o) -> void;
+
+    std::unique_ptr<obj[]> store;
+    std::span<obj>         slots;
+    std::mutex             operation;
+    std::vector<obj*>      free_list;
+    std::atomic<size_t>    used{0};
+};
+
+template <typename T>
+inline object_pool<T>::object_pool(size_t capacity)  //
+    : store{std::make_unique_for_overwrite<obj[]>(capacity)}, slots{store.get(), capacity}
+{
+    free_list.reserve(capacity);
+    for (auto& o : slots)
+    {
+        free_list.push_back(&o);
+    }
+}
+
+template <typename T>
+inline auto object_pool<T>::acquire() -> obj_ptr
+{
+    obj* o = nullptr;
+    {
+        auto guard = std::lock_guard<std::mutex>{operation};
+        if (free_list.empty())
+        {
+            return nullptr;
+        }
+        o = free_list.back();
+        free_list.pop_back();
+        used.store(slots.size() - free_list.size(), std::memory_order_relaxed);
+    }
+    return obj_ptr{o, [this](obj* p) { release(p); }};
+}
+
+template <typename T>
+inline auto object_pool<T>::available() -> size_t
+{
+    auto guard = std::lock_guard<std::mutex>{operation};
+    return free_list.size();
+}
+
+template <typename T>
+inline auto object_pool<T>::release(obj* o) -> void
+{
+    auto guard = std::lock_guard<std::mutex>{operation};
+    free_list.push_back(o);
+    used.store(slots.size() - free_list.size(), std::memory_order_relaxed);
+}
+
+}  // namespace utils
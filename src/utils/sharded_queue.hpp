@@ -0,0 +1,297 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+#include "utils/spsc_ring.hpp"
+#include "utils/wait_strategy.hpp"
+
+namespace utils
+{
+
+/** Zero copy message queue made of several single producer / single consumer lanes.
+ *
+ * Every producer owns one lane and every lane is owned by one consumer worker,
+ * so in the common case there is no contention at all. A worker with no work
+ * in its own lanes steals from the fullest foreign lane, and a worker that is
+ * idle takes over the lanes of a worker that has not returned for stall_timeout.
+ * A lane taken over goes back to its first owner as soon as that one returns.
+ *
+ * Every message is counted in an atomic slot counter. Only workers that park
+ * in the kernel are woken up through a semaphore, so with spinning workers an
+ * enqueue never enters the kernel.
+ */
+template <typename T>
+class sharded_queue
+{
+   public:
+    using msg     = T;
+    using msg_ptr = std::shared_ptr<msg>;  // use a shared pointer for a zero-copy dequeue mechanism
+    using clock   = std::chrono::steady_clock;
+
+    /** @param lanes          number of lanes, i.e. producers
+     *  @param depth          capacity of every lane
+     *  @param workers        number of consumer workers
+     *  @param wait           how the workers wait for messages in ::dequeue()
+     *  @param stall_timeout  time after that a busy worker is considered stalled
+     */
+    sharded_queue(size_t lanes, size_t depth, size_t workers, wait_strategy wait = {},
+                  clock::duration stall_timeout = std::chrono::milliseconds{100});
+
+    sharded_queue(const sharded_queue& other) = delete;
+    auto operator=(const sharded_queue& rhs) -> sharded_queue& = delete;
+
+    sharded_queue(sharded_queue&& rhs) noexcept = delete;
+    auto operator=(sharded_queue&& rhs) noexcept -> sharded_queue& = delete;
+
+    ~sharded_queue() = default;
+
+    /** enqueue the payload to the given lane and signal the consumers.
+     * Each lane must only be fed by a single producer.
+     * @return false if there is no space left in the lane
+     */
+    [[nodiscard]] auto enqueue(size_t lane, msg_ptr&& payload) -> bool;
+
+    /** dequeue on behalf of the given worker, blocks till a message arrives
+     * @return nullptr if the queue was aborted
+     */
+    auto dequeue(size_t worker) -> msg_ptr;
+
+    /** abort and return to all callers from ::dequeue() immediately
+     */
+    auto abort_queue() -> void;
+
+    [[nodiscard]] auto lanes() const -> size_t { return shards.size(); }
+    [[nodiscard]] auto depth() const -> size_t { return shards.front()->ring.capacity(); }
+    [[nodiscard]] auto workers() const -> size_t { return busy_since.size(); }
+
+    /** worker that currently owns the lane */
+    [[nodiscard]] auto owner(size_t lane) const -> size_t { return shards[lane]->owner.load(std::memory_order_relaxed); }
+
+    /** number of queued messages over all lanes, only a snapshot */
+    [[nodiscard]] auto size() const -> size_t;
+
+   private:
+    struct shard
+    {
+        explicit shard(size_t depth, size_t owner) : ring{depth}, home{owner}, owner{owner} {}
+
+        spsc_ring<msg_ptr>  ring;
+        std::atomic_flag    consumer_lock;  // the owner and thieves share the consumer side
+        size_t              home;           // the owner of the lane unless it stalls
+        std::atomic<size_t> owner;
+    };
+
+    auto wait_for_message() -> void;
+    auto try_take_slot() -> bool;
+    auto park() -> void;
+    auto take(size_t lane, msg_ptr& payload) -> bool;
+    auto poll(size_t worker, msg_ptr& payload) -> bool;
+    auto steal(msg_ptr& payload) -> bool;
+    auto rebalance(size_t worker) -> void;
+
+    std::vector<std::unique_ptr<shard>>       shards;
+    std::vector<std::atomic<clock::rep>>      busy_since;  // 0 while the worker waits in dequeue
+    wait_strategy                             wait;
+    clock::duration                           stall_timeout;
+    std::atomic<std::ptrdiff_t>               occupied_slots{0};
+    std::atomic<size_t>                       parked{0};  // workers sleeping in wakeup
+    std::counting_semaphore<>                 wakeup{0};
+    std::atomic<bool>                         aborted{false};
+};
+
+template <typename T>
+inline sharded_queue<T>::sharded_queue(size_t lanes, size_t depth, size_t workers, wait_strategy wait, clock::duration stall_timeout)  //
+    : busy_since(workers), wait{wait}, stall_timeout{stall_timeout}
+{
+    shards.reserve(lanes);
+    for (size_t lane = 0; lane < lanes; ++lane)
+    {
+        shards.push_back(std::make_unique<shard>(depth, lane % workers));
+    }
+}
+
+template <typename T>
+inline auto sharded_queue<T>::enqueue(size_t lane, msg_ptr&& payload) -> bool
+{
+    if (!shards[lane]->ring.push(std::move(payload)))
+    {
+        return false;
+    }
+    // pairs with park(), either the parking worker sees the slot or we see the worker
+    occupied_slots.fetch_add(1, std::memory_order_seq_cst);
+    if (parked.load(std::memory_order_seq_cst) > 0)
+    {
+        wakeup.release();
+    }
+    return true;
+}
+
+template <typename T>
+inline auto sharded_queue<T>::dequeue(size_t worker) -> msg_ptr
+{
+    busy_since[worker].store(0, std::memory_order_relaxed);
+    if (aborted.load(std::memory_order_acquire))
+    {
+        // do not take the wake-ups released on abort, the other workers need them
+        return {};
+    }
+    wait_for_message();  // blocking, till message arrives
+
+    auto payload = msg_ptr{};
+    while (!aborted.load(std::memory_order_acquire))
+    {
+        // the acquired slot guarantees a message in one of the lanes,
+        // but a concurrent thief might be faster on a single lane
+        rebalance(worker);
+        if (poll(worker, payload) || steal(payload))
+        {
+            busy_since[worker].store(clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+            return payload;
+        }
+        std::this_thread::yield();
+    }
+    return payload;
+}
+
+template <typename T>
+inline auto sharded_queue<T>::abort_queue() -> void
+{
+    aborted.store(true, std::memory_order_release);
+    wakeup.release(static_cast<std::ptrdiff_t>(workers()));
+}
+
+template <typename T>
+inline auto sharded_queue<T>::size() const -> size_t
+{
+    auto cnt = size_t{0};
+    for (const auto& s : shards)
+    {
+        cnt += s->ring.size();
+    }
+    return cnt;
+}
+
+template <typename T>
+inline auto sharded_queue<T>::wait_for_message() -> void
+{
+    auto pause = backoff{};
+    auto begin = clock::now();
+    while (!try_take_slot() && !aborted.load(std::memory_order_acquire))
+    {
+        switch (next_step(wait, clock::now() - begin))
+        {
+            case wait_step::spin: pause.pause(); break;
+            case wait_step::yield: std::this_thread::yield(); break;
+            case wait_step::park: park(); break;
+        }
+    }
+}
+
+template <typename T>
+inline auto sharded_queue<T>::try_take_slot() -> bool
+{
+    auto slots = occupied_slots.load(std::memory_order_relaxed);
+    while (slots > 0)
+    {
+        if (occupied_slots.compare_exchange_weak(slots, slots - 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+inline auto sharded_queue<T>::park() -> void
+{
+    parked.fetch_add(1, std::memory_order_seq_cst);
+    if (occupied_slots.load(std::memory_order_seq_cst) == 0 && !aborted.load(std::memory_order_acquire))
+    {
+        // a surplus wake-up only costs another round in wait_for_message
+        wakeup.acquire();
+    }
+    parked.fetch_sub(1, std::memory_order_relaxed);
+}
+
+template <typename T>
+inline auto sharded_queue<T>::take(size_t lane, msg_ptr& payload) -> bool
+{
+    auto& s = *shards[lane];
+    if (s.consumer_lock.test_and_set(std::memory_order_acquire))
+    {
+        return false;
+    }
+    auto ok = s.ring.pop(payload);
+    s.consumer_lock.clear(std::memory_order_release);
+    return ok;
+}
+
+template <typename T>
+inline auto sharded_queue<T>::poll(size_t worker, msg_ptr& payload) -> bool
+{
+    for (size_t lane = 0; lane < shards.size(); ++lane)
+    {
+        if (owner(lane) == worker && take(lane, payload))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+inline auto sharded_queue<T>::steal(msg_ptr& payload) -> bool
+{
+    // under imbalance help out at the longest lane first
+    auto fullest = size_t{0};
+    auto longest = size_t{0};
+    for (size_t lane = 0; lane < shards.size(); ++lane)
+    {
+        if (auto len = shards[lane]->ring.size(); len > longest)
+        {
+            longest = len;
+            fullest = lane;
+        }
+    }
+    return longest > 0 && take(fullest, payload);
+}
+
+template <typename T>
+inline auto sharded_queue<T>::rebalance(size_t worker) -> void
+{
+    auto now = clock::now().time_since_epoch().count();
+    for (size_t lane = 0; lane < shards.size(); ++lane)
+    {
+        auto current = owner(lane);
+        if (current == worker)
+        {
+            continue;
+        }
+        if (shards[lane]->home == worker)
+        {
+            // the first owner is back, hand its lane back
+            shards[lane]->owner.compare_exchange_strong(current, worker, std::memory_order_relaxed);
+            continue;
+        }
+        auto since = busy_since[current].load(std::memory_order_relaxed);
+        if (since != 0 && now - since > stall_timeout.count())
+        {
+            // the owner is stuck in processing a message, take over its lane
+            shards[lane]->owner.compare_exchange_strong(current, worker, std::memory_order_relaxed);
+        }
+    }
+}
+
+}  // namespace utils
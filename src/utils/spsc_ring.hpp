@@ -0,0 +1,94 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace utils
+{
+
+/** Lock-free bounded ring buffer for exactly one producer and one consumer thread.
+ */
+template <typename T>
+class spsc_ring
+{
+   public:
+    explicit spsc_ring(size_t capacity) : buffer(capacity + 1) {}
+
+    spsc_ring(const spsc_ring& other) = delete;
+    auto operator=(const spsc_ring& rhs) -> spsc_ring& = delete;
+
+    spsc_ring(spsc_ring&& rhs) noexcept = delete;
+    auto operator=(spsc_ring&& rhs) noexcept -> spsc_ring& = delete;
+
+    ~spsc_ring() = default;
+
+    /** producer side
+     * @return false if the ring is full
+     */
+    [[nodiscard]] auto push(T&& value) -> bool;
+
+    /** consumer side
+     * @return false if the ring is empty
+     */
+    [[nodiscard]] auto pop(T& value) -> bool;
+
+    /** number of queued elements, only a snapshot if called concurrently
+     */
+    [[nodiscard]] auto size() const -> size_t;
+
+    [[nodiscard]] auto capacity() const -> size_t { return buffer.size() - 1; }
+
+   private:
+    [[nodiscard]] auto next(size_t idx) const -> size_t { return idx + 1 == buffer.size() ? 0 : idx + 1; }
+
+    std::vector<T> buffer;
+
+    // producer and consumer index on their own cache lines, to avoid false sharing
+    static constexpr size_t cache_line = 64;
+    alignas(cache_line) std::atomic<size_t> head{0};  // next to pop
+    alignas(cache_line) std::atomic<size_t> tail{0};  // next to push
+};
+
+template <typename T>
+inline auto spsc_ring<T>::push(T&& value) -> bool
+{
+    auto t = tail.load(std::memory_order_relaxed);
+    auto n = next(t);
+    if (n == head.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    buffer[t] = std::move(value);
+    tail.store(n, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+inline auto spsc_ring<T>::pop(T& value) -> bool
+{
+    auto h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    value = std::move(buffer[h]);
+    head.store(next(h), std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+inline auto spsc_ring<T>::size() const -> size_t
+{
+    auto h = head.load(std::memory_order_acquire);
+    auto t = tail.load(std::memory_order_acquire);
+    return t >= h ? t - h : t + buffer.size() - h;
+}
+
+}  // namespace utils
@@ -6,6 +6,11 @@
 
 #include "utils/thread_runner.hpp"
 
+#include <pthread.h>
+#include <sched.h>
+
+#include "utils/trace.hpp"
+
 #include <iostream>
 #include <utility>
 
@@ -33,9 +38,27 @@ auto thread_runner::run() -> bool
     return true;
 }
 
+auto thread_runner::pin(unsigned cpu) -> void  //
+{
+    core = cpu;
+}
+
 void thread_runner::run_fn(const std::stop_token& stop_token)
 {
+    if (core)
+    {
+        // bind before the first runable, so no work is done on a foreign core
+        auto set = cpu_set_t{};
+        CPU_ZERO(&set);
+        CPU_SET(*core, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+        {
+            std::cerr << "[" << name << "] Failed to pin to cpu " << *core << "\n";
+        }
+    }
+
     std::cout << "[" << name << "] Running\n";
+    trace::set_thread_name(name);
 
     // Register a stop callback on the worker thread.
     std::stop_callback callback(stop_token, runabort);
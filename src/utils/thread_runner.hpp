@@ -9,6 +9,7 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <stop_token>
 #include <thread>
@@ -36,12 +37,18 @@ class thread_runner final
 
     auto run() -> bool;
 
+    /** bind the thread to the given cpu core right when it starts, before it runs the runable.
+     * Has to be called before ::run().
+     */
+    auto pin(unsigned cpu) -> void;
+
    private:
     void run_fn(const std::stop_token& stop_token);
 
-    std::jthread     thread;
-    std::string      name;
-    runable_t        runable;
-    runabort_t       runabort;
+    std::jthread            thread;
+    std::string             name;
+    runable_t               runable;
+    runabort_t              runabort;
+    std::optional<unsigned> core;  // cpu to bind the thread to
 };
 }  // namespace utils
@@ -0,0 +1,264 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "utils/trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace utils::trace
+{
+namespace
+{
+
+/** Single writer ring buffer of trace events.
+ *
+ * Each slot is guarded by a sequence number (seqlock), so a concurrent
+ * dump can detect and skip slots that are rewritten while being read.
+ */
+struct ring
+{
+    struct slot
+    {
+        std::atomic<std::uint64_t> seq{0};
+        std::atomic<const char*>   name{nullptr};
+        std::atomic<std::uint64_t> frame_id{0};
+        std::atomic<std::int64_t>  begin{0};
+        std::atomic<std::int64_t>  duration{0};
+    };
+
+    auto push(const char* name, std::uint64_t frame_id, time_point begin, time_point end) -> void
+    {
+        auto  idx = head.load(std::memory_order_relaxed);
+        auto& s   = slots[idx % ring_size];
+
+        s.seq.store(2 * idx + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.name.store(name, std::memory_order_relaxed);
+        s.frame_id.store(frame_id, std::memory_order_relaxed);
+        s.begin.store(begin.time_since_epoch().count(), std::memory_order_relaxed);
+        s.duration.store((end - begin).count(), std::memory_order_relaxed);
+        s.seq.store(2 * idx + 2, std::memory_order_release);
+
+        head.store(idx + 1, std::memory_order_release);
+    }
+
+    std::array<slot, ring_size> slots;
+    std::atomic<std::uint64_t>  head{0};
+    std::atomic<std::uint64_t>  tail{0};  // first event to dump
+    std::mutex                  name_lock;
+    std::string                 thread_name;
+    std::uint32_t               tid{0};
+};
+
+struct registry
+{
+    std::mutex                         operation;
+    std::vector<std::shared_ptr<ring>> rings;
+};
+
+auto the_registry() -> registry&
+{
+    static auto r = registry{};
+    return r;
+}
+
+std::atomic<std::uint64_t> sampling{0};
+
+// the ring is shared with the registry, so events survive the end of the thread
+thread_local std::shared_ptr<ring> local_ring;
+thread_local std::uint64_t         current_frame_id = 0;
+thread_local bool                  current_active   = false;
+
+auto this_ring() -> ring&
+{
+    if (!local_ring)
+    {
+        auto& r    = the_registry();
+        auto  g    = std::lock_guard<std::mutex>{r.operation};
+        local_ring = std::make_shared<ring>();
+        local_ring->tid = static_cast<std::uint32_t>(r.rings.size() + 1);
+        r.rings.push_back(local_ring);
+    }
+    return *local_ring;
+}
+
+auto to_us(std::int64_t ticks) -> double  //
+{
+    return std::chrono::duration<double, std::micro>{clock::duration{ticks}}.count();
+}
+
+/** splitmix64 finalizer. The frame ids of a lane are a multiple of the lanes apart,
+ * so a plain modulo would never sample some lanes.
+ */
+auto spread(std::uint64_t x) -> std::uint64_t
+{
+    x = (x ^ (x >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27U)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31U);
+}
+
+/** escape s for a JSON string
+ */
+auto escape(const std::string& s) -> std::string
+{
+    auto out = std::string{};
+    out.reserve(s.size());
+    for (auto c : s)
+    {
+        switch (c)
+        {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    auto buffer = std::array<char, 8>{};
+                    std::snprintf(buffer.data(), buffer.size(), "\\u%04x", static_cast<unsigned>(c));
+                    out += buffer.data();
+                }
+                else
+                {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+auto set_sampling(std::uint64_t every_nth) -> void  //
+{
+    sampling.store(every_nth, std::memory_order_relaxed);
+}
+
+auto sampled(std::uint64_t frame_id) -> bool
+{
+    auto n = sampling.load(std::memory_order_relaxed);
+    return n != 0 && spread(frame_id) % n == 0;
+}
+
+auto set_thread_name(std::string name) -> void
+{
+    auto& r = this_ring();
+    auto  g = std::lock_guard<std::mutex>{r.name_lock};
+    r.thread_name = std::move(name);
+}
+
+auto record(const char* name, std::uint64_t frame_id, time_point begin) -> void
+{
+    if (sampled(frame_id))
+    {
+        this_ring().push(name, frame_id, begin, clock::now());
+    }
+}
+
+auto dump(std::ostream& os) -> size_t
+{
+    auto rings = std::vector<std::shared_ptr<ring>>{};
+    {
+        auto& r = the_registry();
+        auto  g = std::lock_guard<std::mutex>{r.operation};
+        rings   = r.rings;
+    }
+
+    auto cnt       = size_t{0};
+    auto separator = "\n";
+    auto flags     = os.flags();
+    auto precision = os.precision();
+    os << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+    for (const auto& r : rings)
+    {
+        {
+            auto g = std::lock_guard<std::mutex>{r->name_lock};
+            if (!r->thread_name.empty())
+            {
+                os << separator << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << r->tid << R"(,"args":{"name":")"
+                   << escape(r->thread_name) << "\"}}";
+                separator = ",\n";
+            }
+        }
+
+        auto head  = r->head.load(std::memory_order_acquire);
+        auto first = std::max(head > ring_size ? head - ring_size : 0, r->tail.load(std::memory_order_relaxed));
+        for (auto idx = first; idx < head; ++idx)
+        {
+            const auto& s   = r->slots[idx % ring_size];
+            auto        seq = s.seq.load(std::memory_order_acquire);
+            if (seq != 2 * idx + 2)
+            {  // already overwritten by a newer event
+                continue;
+            }
+            const auto* name     = s.name.load(std::memory_order_relaxed);
+            auto        frame_id = s.frame_id.load(std::memory_order_relaxed);
+            auto        begin    = s.begin.load(std::memory_order_relaxed);
+            auto        duration = s.duration.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.seq.load(std::memory_order_relaxed) != seq)
+            {  // rewritten while reading
+                continue;
+            }
+
+            os << separator << R"({"name":")" << name << R"(","cat":"cpc","ph":"X","pid":1,"tid":)" << r->tid
+               << R"(,"ts":)" << to_us(begin) << R"(,"dur":)" << to_us(duration) << R"(,"args":{"frame":)" << frame_id << "}}";
+            separator = ",\n";
+            cnt++;
+        }
+    }
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    os.flags(flags);
+    os.precision(precision);
+    return cnt;
+}
+
+auto clear() -> void
+{
+    auto& r = the_registry();
+    auto  g = std::lock_guard<std::mutex>{r.operation};
+    for (auto& ring : r.rings)
+    {
+        // the rings of running threads must not be touched, just forget what they recorded so far
+        ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+scope::scope(const char* name, std::uint64_t frame_id)  //
+    : name{name}, frame_id{frame_id}, outer_frame_id{current_frame_id}, outer_active{current_active}, active{sampled(frame_id)}
+{
+    current_frame_id = frame_id;
+    current_active   = active;
+    if (active)
+    {
+        begin = clock::now();
+    }
+}
+
+scope::scope(const char* name)  //
+    : name{name}, frame_id{current_frame_id}, outer_frame_id{current_frame_id}, outer_active{current_active}, active{current_active}
+{
+    if (active)
+    {
+        begin = clock::now();
+    }
+}
+
+scope::~scope()
+{
+    if (active)
+    {
+        this_ring().push(name, frame_id, begin, clock::now());
+    }
+    current_frame_id = outer_frame_id;
+    current_active   = outer_active;
+}
+
+}  // namespace utils::trace
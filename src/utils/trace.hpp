@@ -0,0 +1,82 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace utils::trace
+{
+using clock      = std::chrono::steady_clock;
+using time_point = clock::time_point;
+
+/** number of events kept per thread, older events get overwritten */
+constexpr size_t ring_size = 4096;
+
+/** trace every n-th frame, 0 disables tracing at all. The frames are picked by a hash
+ * of their id, so all lanes are sampled evenly.
+ */
+auto set_sampling(std::uint64_t every_nth) -> void;
+
+/** @return true if events of the given frame are recorded
+ */
+auto sampled(std::uint64_t frame_id) -> bool;
+
+/** name the calling thread in the trace output
+ */
+auto set_thread_name(std::string name) -> void;
+
+/** record a complete event that started at begin and ends now
+ */
+auto record(const char* name, std::uint64_t frame_id, time_point begin) -> void;
+
+/** write all recorded events of all threads in Chrome trace event format (JSON)
+ *
+ * Safe to call while other threads are tracing. Events that are overwritten
+ * during the dump are skipped.
+ * @return number of written events
+ */
+auto dump(std::ostream& os) -> size_t;
+
+/** drop all recorded events
+ */
+auto clear() -> void;
+
+/** Scoped trace event.
+ *
+ * Records the time between construction and destruction into a thread local
+ * ring buffer, without any lock. Scopes without an explicit frame id belong
+ * to the frame of the enclosing scope.
+ */
+class scope
+{
+   public:
+    scope(const char* name, std::uint64_t frame_id);
+    explicit scope(const char* name);
+
+    scope(const scope& other) = delete;
+    auto operator=(const scope& rhs) -> scope& = delete;
+
+    scope(scope&& rhs) noexcept = delete;
+    auto operator=(scope&& rhs) noexcept -> scope& = delete;
+
+    ~scope();
+
+   private:
+    const char*   name;
+    std::uint64_t frame_id;
+    std::uint64_t outer_frame_id;
+    bool          outer_active;
+    bool          active;
+    time_point    begin;
+};
+
+}  // namespace utils::trace
@@ -0,0 +1,125 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+
+#include <chrono>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace utils
+{
+
+/** how a consumer waits for the next message
+ */
+enum class wait_policy
+{
+    block,       // sleep in the kernel right away, no cpu cost but a wake-up latency
+    spin,        // busy poll forever, lowest latency but burns a whole core
+    spin_yield,  // busy poll for the spin budget, then keep polling but yield the core in between
+    spin_park,   // busy poll for the spin budget, then sleep in the kernel
+};
+
+struct wait_strategy
+{
+    wait_policy              policy      = wait_policy::block;
+    std::chrono::nanoseconds spin_budget = std::chrono::microseconds{50};
+};
+
+/** what a waiter does next
+ */
+enum class wait_step
+{
+    spin,   // pause and poll again
+    yield,  // yield the core and poll again
+    park,   // sleep in the kernel till it is woken up
+};
+
+/** @return the next step of a waiter that has been waiting for the given time
+ */
+inline auto next_step(const wait_strategy& w, std::chrono::nanoseconds waited) -> wait_step
+{
+    switch (w.policy)
+    {
+        case wait_policy::block: return wait_step::park;
+        case wait_policy::spin: return wait_step::spin;
+        case wait_policy::spin_yield: return waited < w.spin_budget ? wait_step::spin : wait_step::yield;
+        case wait_policy::spin_park: return waited < w.spin_budget ? wait_step::spin : wait_step::park;
+    }
+    return wait_step::park;
+}
+
+inline auto to_string(wait_policy p) -> std::string_view
+{
+    switch (p)
+    {
+        case wait_policy::block: return "block";
+        case wait_policy::spin: return "spin";
+        case wait_policy::spin_yield: return "spin-yield";
+        case wait_policy::spin_park: return "spin-park";
+    }
+    return "unknown";
+}
+
+inline auto parse_wait_policy(std::string_view s) -> wait_policy
+{
+    for (auto p : {wait_policy::block, wait_policy::spin, wait_policy::spin_yield, wait_policy::spin_park})
+    {
+        if (s == to_string(p))
+        {
+            return p;
+        }
+    }
+    throw std::invalid_argument("unknown wait policy");
+}
+
+/** tell the cpu that we are in a spin loop
+ */
+inline auto cpu_relax() -> void
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/** Exponential backoff for spin loops.
+ *
+ * Every call pauses twice as long as the previous one, up to a limit, so a
+ * spinning core does not hammer the shared cache line and leaves execution
+ * resources to its hyper-thread sibling.
+ */
+class backoff
+{
+   public:
+    static constexpr unsigned max_pauses = 64;
+
+    auto pause() -> void
+    {
+        for (auto i = 0U; i < pauses; ++i)
+        {
+            cpu_relax();
+        }
+        if (pauses < max_pauses)
+        {
+            pauses *= 2;
+        }
+    }
+
+    /** number of pauses the next call spins */
+    [[nodiscard]] auto length() const -> unsigned { return pauses; }
+
+   private:
+    unsigned pauses{1};
+};
+
+}  // namespace utils
@@ -0,0 +1,8 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#define BOOST_TEST_MODULE cpc_test
+#include <boost/test/unit_test.hpp>
@@ -0,0 +1,127 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "cpc/integrity.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <memory>
+
+namespace cpc
+{
+
+BOOST_AUTO_TEST_SUITE(suite_integrity)
+
+struct Fixture
+{
+    Fixture() : msg{std::make_unique<message>()} { msg->payload.emplace<hw_frame>(); }
+
+    auto feed(std::uint64_t sequence, size_t lane = 0) -> bool
+    {
+        msg->tail = trailer{lane, sequence};
+        return checker(*msg);
+    }
+
+    integrity_checker        checker{2};
+    std::unique_ptr<message> msg;
+};
+
+BOOST_FIXTURE_TEST_CASE(test_corrupt, Fixture)
+{
+    auto& frame = std::get<hw_frame>(msg->payload);
+    frame.fill('a');
+    msg->tail = trailer{0, 1, io::checksum(frame), true};
+    BOOST_TEST(checker(*msg));
+    BOOST_TEST(checker.corrupt() == 0);
+
+    // the header is not covered, the dispatchers rewrite it
+    frame[0] = 'x';
+    msg->tail.sequence = 2;
+    BOOST_TEST(checker(*msg));
+
+    frame[frame.size() / 2] ^= 0x01;
+    msg->tail.sequence = 3;
+    BOOST_TEST(!checker(*msg));
+    BOOST_TEST(checker.corrupt() == 1);
+    BOOST_TEST(checker.checked() == 3);
+
+    // a trailer naming a lane that does not exist
+    BOOST_TEST(!feed(1, 2));
+    BOOST_TEST(checker.corrupt() == 2);
+    BOOST_TEST(checker.missing() == 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sequence, Fixture)
+{
+    for (auto seq : {1, 2, 4})
+    {
+        feed(seq);
+    }
+    BOOST_TEST(checker.missing() == 1);
+    BOOST_TEST(checker.reordered() == 0);
+
+    // the late frame closes the gap
+    feed(3);
+    BOOST_TEST(checker.reordered() == 1);
+    BOOST_TEST(checker.missing() == 0);
+
+    // lanes are tracked on their own
+    feed(1, 1);
+    feed(3, 1);
+    BOOST_TEST(checker.missing() == 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_duplicate, Fixture)
+{
+    feed(1);
+    feed(2);
+    feed(2);
+    feed(1);
+    BOOST_TEST(checker.duplicated() == 2);
+    BOOST_TEST(checker.missing() == 0);
+    BOOST_TEST(checker.reordered() == 0);
+
+    // a duplicate of a late frame does not close a gap twice
+    feed(4);
+    feed(3);
+    feed(3);
+    BOOST_TEST(checker.missing() == 0);
+    BOOST_TEST(checker.reordered() == 1);
+    BOOST_TEST(checker.duplicated() == 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_window, Fixture)
+{
+    feed(1);
+    feed(2 + integrity_checker::window);
+    BOOST_TEST(checker.missing() == integrity_checker::window);
+
+    // too old to tell it from a duplicate
+    feed(2);
+    BOOST_TEST(checker.duplicated() == 1);
+
+    feed(3 + integrity_checker::window / 2);
+    BOOST_TEST(checker.reordered() == 1);
+    BOOST_TEST(checker.missing() == integrity_checker::window - 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_reset_statistics, Fixture)
+{
+    feed(1);
+    feed(3);
+    checker.reset_statistics();
+    BOOST_TEST(checker.checked() == 0);
+    BOOST_TEST(checker.missing() == 0);
+
+    // the sequences seen before are kept
+    feed(4);
+    feed(3);
+    BOOST_TEST(checker.missing() == 0);
+    BOOST_TEST(checker.duplicated() == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace cpc
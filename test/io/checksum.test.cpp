@@ -0,0 +1,112 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "io/checksum.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <string_view>
+#include <vector>
+
+#include "io/copy_engine.hpp"
+
+namespace io
+{
+
+BOOST_AUTO_TEST_SUITE(suite_checksum)
+
+struct Fixture
+{
+    static auto make_data(size_t size)
+    {
+        auto v     = std::vector<char>(size);
+        auto state = 0x12345678U;
+        for (auto& c : v)
+        {
+            state = state * 1103515245U + 12345U;
+            c     = static_cast<char>(state >> 16);
+        }
+        return v;
+    }
+
+    /** bitwise reference implementation */
+    static auto reference(const std::vector<char>& v, size_t offset = 0)
+    {
+        auto crc = ~0U;
+        for (size_t i = offset; i < v.size(); ++i)
+        {
+            crc ^= static_cast<unsigned char>(v[i]);
+            for (auto bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78U : crc >> 1;
+            }
+        }
+        return ~crc;
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(test_known_value, Fixture)
+{
+    constexpr auto s = std::string_view{"123456789"};
+    BOOST_CHECK_EQUAL(crc32c(s.data(), s.size()), 0xE3069283U);
+    BOOST_CHECK_EQUAL(crc32c(s.data(), 0), 0U);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sizes, Fixture)
+{
+    for (size_t size : {1, 7, 8, 9, 4095, 3 * 4096, 3 * 4096 + 5, 100000})
+    {
+        auto v = make_data(size);
+        BOOST_TEST_REQUIRE(crc32c(v.data(), v.size()) == reference(v), "size " << size);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_chain_and_combine, Fixture)
+{
+    auto v     = make_data(50000);
+    auto split = size_t{12345};
+    auto a     = crc32c(v.data(), split);
+    auto b     = crc32c(v.data() + split, v.size() - split);
+    BOOST_CHECK_EQUAL(crc32c(v.data() + split, v.size() - split, a), reference(v));
+    BOOST_CHECK_EQUAL(crc32c_combine(a, b, v.size() - split), reference(v));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_copy_crc, Fixture)
+{
+    auto saved = copy_configuration();
+    // with the most helpers the tail parts of the smaller sizes get no data at all
+    for (unsigned threads : {0U, 2U, max_copy_threads})
+    {
+        auto cfg               = copy_config{};
+        cfg.stream_threshold   = 1024;
+        cfg.parallel_threshold = 64 * 1024;
+        cfg.cached_head        = 100;
+        cfg.threads            = threads;
+        configure_copy(cfg);
+
+        for (size_t size : {10, 1023, 5000, 64 * 1024 + 7, 1024 * 1024 + 13})
+        {
+            for (size_t crc_offset : {0, 64, 200})
+            {
+                auto src = make_data(size);
+                auto dst = std::vector<char>(size);
+                auto crc = copy_memory_crc32c(dst.data(), src.data(), size, crc_offset);
+                BOOST_TEST_REQUIRE((dst == src));
+                BOOST_TEST_REQUIRE(crc == reference(src, std::min(crc_offset, size)),
+                                   "size " << size << " offset " << crc_offset << " threads " << threads);
+            }
+        }
+    }
+
+    auto cfg    = copy_config{};
+    cfg.threads = max_copy_threads + 1;
+    configure_copy(cfg);
+    BOOST_TEST(copy_configuration().threads == max_copy_threads);
+    configure_copy(saved);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace io
@@ -0,0 +1,90 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "io/copy_engine.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <numeric>
+#include <vector>
+
+namespace io
+{
+
+BOOST_AUTO_TEST_SUITE(suite_copy_engine)
+
+struct Fixture
+{
+    Fixture() : saved{copy_configuration()}
+    {
+        // small thresholds, so the streaming and the parallel path get exercised with small buffers
+        auto cfg               = copy_config{};
+        cfg.stream_threshold   = 1024;
+        cfg.parallel_threshold = 64 * 1024;
+        cfg.cached_head        = 100;
+        cfg.threads            = 2;
+        configure_copy(cfg);
+    }
+    ~Fixture() { configure_copy(saved); }
+
+    static auto make_source(size_t size)
+    {
+        auto v = std::vector<char>(size);
+        std::iota(v.begin(), v.end(), 0);
+        return v;
+    }
+
+    copy_config saved;
+};
+
+BOOST_FIXTURE_TEST_CASE(test_copy, Fixture)
+{
+    for (size_t size : {0, 1, 63, 1023, 1024, 4097, 64 * 1024 - 1, 64 * 1024, 1024 * 1024 + 13})
+    {
+        for (size_t offset : {0, 1, 17})
+        {
+            auto src = make_source(size + offset);
+            auto dst = std::vector<char>(size + offset, 'x');
+            copy_memory(dst.data() + offset, src.data() + offset, size);
+            BOOST_TEST_REQUIRE((std::equal(dst.begin() + offset, dst.end(), src.begin() + offset)), "size " << size << " offset " << offset);
+            BOOST_TEST_REQUIRE((std::count(dst.begin(), dst.begin() + offset, 'x') == static_cast<std::ptrdiff_t>(offset)));
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_fill, Fixture)
+{
+    for (size_t size : {0, 1, 1023, 1025, 64 * 1024, 1024 * 1024 + 13})
+    {
+        auto dst = std::vector<char>(size + 3, 'x');
+        fill_memory(dst.data() + 1, 'a', size);
+        BOOST_TEST_REQUIRE(dst.front() == 'x');
+        BOOST_TEST_REQUIRE((std::count(dst.begin(), dst.end(), 'a') == static_cast<std::ptrdiff_t>(size)), "size " << size);
+        BOOST_TEST_REQUIRE(dst.back() == 'x');
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_plain_copy, Fixture)
+{
+    auto cfg      = copy_configuration();
+    cfg.streaming = false;
+    cfg.threads   = 0;
+    configure_copy(cfg);
+
+    auto src = make_source(128 * 1024);
+    auto dst = std::vector<char>(src.size());
+    copy_memory(dst.data(), src.data(), src.size());
+    BOOST_TEST((dst == src));
+}
+
+BOOST_AUTO_TEST_CASE(test_isa)
+{
+    auto isa = std::string{copy_isa()};
+    BOOST_TEST((isa == "avx2" || isa == "sse2" || isa == "generic"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace io
@@ -0,0 +1,139 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "utils/load_model.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+namespace utils
+{
+
+using namespace std::chrono_literals;
+
+namespace
+{
+auto mean_cost(const load_model& model, std::uint64_t frames) -> double
+{
+    auto sum = 0.0;
+    for (std::uint64_t id = 0; id < frames; ++id)
+    {
+        sum += static_cast<double>(model.cost(id).count());
+    }
+    return sum / static_cast<double>(frames);
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(suite_load_model)
+
+BOOST_AUTO_TEST_CASE(test_parse)
+{
+    BOOST_TEST((parse_load_spec("none").work == workload::none));
+
+    auto spec = parse_load_spec("memory:pareto:2500:2.5");
+    BOOST_TEST((spec.work == workload::memory));
+    BOOST_TEST((spec.dist == cost_distribution::pareto));
+    BOOST_TEST(spec.mean.count() == 2500);
+    BOOST_TEST(spec.parameter == 2.5);
+    BOOST_TEST(to_string(spec) == "memory:pareto:2500:2.5");
+    BOOST_TEST(to_string(parse_load_spec("io:constant:10000")) == "io:constant:10000");
+
+    BOOST_CHECK_THROW(parse_load_spec("cpu"), std::invalid_argument);
+    BOOST_CHECK_THROW(parse_load_spec("gpu:constant:10"), std::invalid_argument);
+    BOOST_CHECK_THROW(parse_load_spec("cpu:uniform:10"), std::invalid_argument);
+    BOOST_CHECK_THROW(parse_load_spec("cpu:constant:10ms"), std::invalid_argument);
+    BOOST_CHECK_THROW(parse_load_spec("cpu:pareto:10:0.5"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_deterministic)
+{
+    auto spec = parse_load_spec("cpu:normal:1000");
+    auto a    = load_model{spec, 42};
+    auto b    = load_model{spec, 42};
+    auto c    = load_model{spec, 43};
+
+    auto differs = false;
+    for (std::uint64_t id = 0; id < 100; ++id)
+    {
+        BOOST_TEST(a.cost(id).count() == b.cost(id).count());
+        differs |= a.cost(id) != c.cost(id);
+    }
+    BOOST_TEST(differs);
+}
+
+BOOST_AUTO_TEST_CASE(test_distributions)
+{
+    BOOST_TEST(load_model{}.cost(1).count() == 0);
+    BOOST_TEST((load_model{parse_load_spec("io:constant:1000"), 1}.cost(7) == 1ms));
+
+    auto normal = load_model{parse_load_spec("cpu:normal:1000:100"), 1};
+    BOOST_TEST(mean_cost(normal, 10000) == 1e6, boost::test_tools::tolerance(0.01));
+
+    // the cap cuts off a bit of the mean of the heavy tail
+    auto pareto = load_model{parse_load_spec("cpu:pareto:1000:2.5"), 1};
+    BOOST_TEST(mean_cost(pareto, 100000) == 1e6, boost::test_tools::tolerance(0.05));
+    auto highest = std::chrono::nanoseconds{0};
+    for (std::uint64_t id = 0; id < 100000; ++id)
+    {
+        highest = std::max(highest, pareto.cost(id));
+    }
+    BOOST_TEST((highest > 5ms));
+    BOOST_TEST((highest <= 100ms));
+
+    // bursts hit whole runs of frames, roughly one in ten
+    auto bursty = load_model{parse_load_spec("cpu:bursty:1000:5"), 1};
+    auto bursts = 0;
+    for (std::uint64_t id = 0; id < 80000; id += 8)
+    {
+        auto burst = bursty.cost(id) == 5ms;
+        bursts += burst ? 1 : 0;
+        for (std::uint64_t i = 1; i < 8; ++i)
+        {
+            BOOST_TEST((bursty.cost(id + i) == bursty.cost(id)));
+        }
+    }
+    BOOST_TEST(bursts > 800);
+    BOOST_TEST(bursts < 1200);
+}
+
+BOOST_AUTO_TEST_CASE(test_gap)
+{
+    BOOST_TEST((load_model{parse_load_spec("io:constant:1000"), 1}.gap(7) == 1ms));
+
+    // bursts of arrivals come faster, on the same runs where the cost would be higher
+    auto bursty = load_model{parse_load_spec("io:bursty:1000:5"), 1};
+    auto bursts = 0;
+    for (std::uint64_t n = 0; n < 80000; n += 8)
+    {
+        auto burst = bursty.gap(n) == 200us;
+        BOOST_TEST((burst ? bursty.cost(n) == 5ms : bursty.gap(n) == 1ms));
+        bursts += burst ? 1 : 0;
+        for (std::uint64_t i = 1; i < 8; ++i)
+        {
+            BOOST_TEST((bursty.gap(n + i) == bursty.gap(n)));
+        }
+    }
+    BOOST_TEST(bursts > 800);
+    BOOST_TEST(bursts < 1200);
+}
+
+BOOST_AUTO_TEST_CASE(test_apply)
+{
+    auto data = std::vector<char>(1024 * 1024, 'a');
+    for (auto spec : {"cpu:constant:2000", "memory:constant:2000", "io:constant:2000"})
+    {
+        auto model = load_model{parse_load_spec(spec), 1};
+        auto begin = std::chrono::steady_clock::now();
+        model.apply(1, data);
+        BOOST_TEST((std::chrono::steady_clock::now() - begin >= 2ms), spec);
+    }
+    BOOST_CHECK_NO_THROW(load_model{}.apply(1, {}));
+    BOOST_CHECK_NO_THROW((load_model{parse_load_spec("memory:constant:10"), 1}.apply(1, {})));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace utils
@@ -0,0 +1,40 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "utils/memory.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+namespace utils
+{
+
+BOOST_AUTO_TEST_SUITE(suite_memory)
+
+BOOST_AUTO_TEST_CASE(test_prefault_keeps_content)
+{
+    auto mem = std::vector<char>(3 * 4096 + 17);
+    for (size_t i = 0; i < mem.size(); ++i)
+    {
+        mem[i] = static_cast<char>(i);
+    }
+
+    utils::prefault(mem.data(), mem.size());
+
+    for (size_t i = 0; i < mem.size(); ++i)
+    {
+        BOOST_REQUIRE_EQUAL(mem[i], static_cast<char>(i));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_prefault_empty)
+{
+    BOOST_CHECK_NO_THROW(utils::prefault(nullptr, 0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace utils
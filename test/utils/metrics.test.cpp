@@ -0,0 +1,183 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "utils/metrics.hpp"
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "utils/metrics_server.hpp"
+
+namespace utils::metrics
+{
+
+BOOST_AUTO_TEST_SUITE(suite_metrics)
+
+BOOST_AUTO_TEST_CASE(test_counter)
+{
+    auto c       = counter{};
+    auto threads = std::vector<std::thread>{};
+    for (auto t = 0; t < 4; ++t)
+    {
+        threads.emplace_back(
+            [&c]()
+            {
+                for (auto i = 0; i < 10000; ++i)
+                {
+                    c.add();
+                }
+            });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    BOOST_TEST(c.value() == 40000);
+    c.reset();
+    BOOST_TEST(c.value() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_histogram)
+{
+    auto h = histogram{{1, 2, 4}};
+    for (auto v : {0.5, 1.0, 1.5, 3.0, 8.0})
+    {
+        h.observe(v);
+    }
+    BOOST_TEST(h.buckets() == (std::vector<std::uint64_t>{2, 1, 1, 1}), boost::test_tools::per_element());
+    BOOST_TEST(h.sum() == 14.0);
+
+    h.observe(std::chrono::milliseconds{500});
+    BOOST_TEST(h.buckets()[0] == 3);
+
+    h.reset();
+    BOOST_TEST(h.buckets() == (std::vector<std::uint64_t>{0, 0, 0, 0}), boost::test_tools::per_element());
+    BOOST_TEST(h.sum() == 0.0);
+
+    BOOST_CHECK_THROW(histogram({2, 1}), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_histogram_threads)
+{
+    // more buckets than fit into one cache line, observed from several shards
+    auto h       = histogram{{1, 2, 3, 4, 5, 6, 7, 8, 9, 10}};
+    auto threads = std::vector<std::thread>{};
+    for (auto t = 0; t < 4; ++t)
+    {
+        threads.emplace_back(
+            [&h]()
+            {
+                for (auto i = 0; i < 11000; ++i)
+                {
+                    h.observe(static_cast<double>(i % 11) + 0.5);
+                }
+            });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    auto counts = h.buckets();
+    BOOST_TEST(counts == std::vector<std::uint64_t>(11, 4000), boost::test_tools::per_element());
+    BOOST_TEST(h.sum() == 4 * 1000 * 60.5);
+}
+
+BOOST_AUTO_TEST_CASE(test_registry)
+{
+    auto r = registry{};
+    auto& c = r.make_counter("frames_total", "all frames", {{"lane", "0"}});
+    c.add(3);
+    BOOST_TEST(&c == &r.make_counter("frames_total", "all frames", {{"lane", "0"}}));
+    r.make_counter("frames_total", "all frames", {{"lane", "1"}}).add();
+    r.make_gauge("depth", "queue \"depth\"").set(2.5);
+    r.make_sampled_gauge("sampled", "sampled value", []() { return 7.0; });
+    r.make_histogram("latency_seconds", "latency", {{"stage", "a"}}, {0.1, 1}).observe(0.5);
+    BOOST_CHECK_THROW(r.make_gauge("frames_total", "all frames"), std::invalid_argument);
+
+    auto os = std::ostringstream{};
+    r.write(os);
+    auto text = os.str();
+    BOOST_TEST(text.find("# TYPE frames_total counter\n") != std::string::npos);
+    BOOST_TEST(text.find("frames_total{lane=\"0\"} 3\n") != std::string::npos);
+    BOOST_TEST(text.find("frames_total{lane=\"1\"} 1\n") != std::string::npos);
+    BOOST_TEST(text.find("# HELP depth queue \"depth\"\n") != std::string::npos);
+    BOOST_TEST(text.find("depth 2.5\n") != std::string::npos);
+    BOOST_TEST(text.find("sampled 7\n") != std::string::npos);
+    BOOST_TEST(text.find("latency_seconds_bucket{stage=\"a\",le=\"0.1\"} 0\n") != std::string::npos);
+    BOOST_TEST(text.find("latency_seconds_bucket{stage=\"a\",le=\"1\"} 1\n") != std::string::npos);
+    BOOST_TEST(text.find("latency_seconds_bucket{stage=\"a\",le=\"+Inf\"} 1\n") != std::string::npos);
+    BOOST_TEST(text.find("latency_seconds_sum{stage=\"a\"} 0.5\n") != std::string::npos);
+    BOOST_TEST(text.find("latency_seconds_count{stage=\"a\"} 1\n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_server)
+{
+    using boost::asio::ip::tcp;
+
+    auto r = registry{};
+    r.make_counter("scraped_total", "test counter").add(42);
+
+    auto ioc    = boost::asio::io_context{};
+    auto s      = server{ioc, r, "127.0.0.1", 0};
+    auto runner = std::thread{[&ioc]() { ioc.run(); }};
+
+    auto scrape = [port = s.port()](const std::string& target)
+    {
+        auto client_ctx = boost::asio::io_context{};
+        auto socket     = tcp::socket{client_ctx};
+        socket.connect(tcp::endpoint{boost::asio::ip::make_address("127.0.0.1"), port});
+        auto request = "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        boost::asio::write(socket, boost::asio::buffer(request));
+
+        auto response = std::string{};
+        auto ec       = boost::system::error_code{};
+        boost::asio::read(socket, boost::asio::dynamic_buffer(response), ec);
+        return response;
+    };
+
+    auto ok = scrape("/metrics");
+    BOOST_TEST(ok.starts_with("HTTP/1.1 200 OK\r\n"));
+    BOOST_TEST(ok.find("text/plain; version=0.0.4") != std::string::npos);
+    BOOST_TEST(ok.find("scraped_total 42\n") != std::string::npos);
+    BOOST_TEST(scrape("/other").starts_with("HTTP/1.1 404"));
+
+    ioc.stop();
+    runner.join();
+}
+
+BOOST_AUTO_TEST_CASE(test_server_timeout)
+{
+    using boost::asio::ip::tcp;
+
+    auto r      = registry{};
+    auto ioc    = boost::asio::io_context{};
+    auto s      = server{ioc, r, "127.0.0.1", 0, std::chrono::milliseconds{50}};
+    auto runner = std::thread{[&ioc]() { ioc.run(); }};
+
+    // an idle client that never sends its request gets disconnected
+    auto client_ctx = boost::asio::io_context{};
+    auto socket     = tcp::socket{client_ctx};
+    socket.connect(tcp::endpoint{boost::asio::ip::make_address("127.0.0.1"), s.port()});
+    auto begin    = std::chrono::steady_clock::now();
+    auto response = std::string{};
+    auto ec       = boost::system::error_code{};
+    boost::asio::read(socket, boost::asio::dynamic_buffer(response), ec);
+    BOOST_TEST(ec);
+    BOOST_TEST(response.empty());
+    BOOST_TEST((std::chrono::steady_clock::now() - begin < std::chrono::seconds{5}));
+
+    ioc.stop();
+    runner.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace utils::metrics
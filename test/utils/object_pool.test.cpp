@@ -0,0 +1,61 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "utils/object_pool.hpp"
+
+#include <array>
+#include <boost/test/unit_test.hpp>
+
+namespace utils
+{
+
+BOOST_AUTO_TEST_SUITE(suite_object_pool)
+
+struct Fixture
+{
+    using obj_type = std::array<char, 1>;
+};
+
+BOOST_FIXTURE_TEST_CASE(test_acquire, Fixture)
+{
+    auto pool = utils::object_pool<obj_type>{2};
+    BOOST_CHECK_EQUAL(pool.capacity(), 2);
+
+    auto o1 = pool.acquire();
+    auto o2 = pool.acquire();
+    BOOST_TEST(o1);
+    BOOST_TEST(o2);
+    BOOST_TEST(o1 != o2);
+    BOOST_TEST(!pool.acquire());
+    BOOST_CHECK_EQUAL(pool.available(), 0);
+    BOOST_CHECK_EQUAL(pool.in_use(), 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_release, Fixture)
+{
+    auto pool = utils::object_pool<obj_type>{1};
+    {
+        auto o = pool.acquire();
+        BOOST_TEST_REQUIRE(o);
+        (*o)[0] = 'x';
+
+        auto shared = o;
+        o.reset();
+        BOOST_CHECK_EQUAL(pool.available(), 0);
+    }
+    BOOST_CHECK_EQUAL(pool.available(), 1);
+    BOOST_CHECK_EQUAL(pool.in_use(), 0);
+
+    // the very same object comes back
+    auto o = pool.acquire();
+    BOOST_TEST_REQUIRE(o);
+    BOOST_CHECK_EQUAL((*o)[0], 'x');
+    BOOST_TEST(o.get() == pool.storage().data());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace utils
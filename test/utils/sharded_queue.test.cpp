@@ -0,0 +1,126 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "utils/sharded_queue.hpp"
+
+#include <array>
+#include <boost/test/unit_test.hpp>
+#include <thread>
+
+namespace utils
+{
+
+BOOST_AUTO_TEST_SUITE(suite_sharded_queue)
+
+struct Fixture
+{
+    using msg_type = std::array<char, 1>;
+    auto make_msg(char c) { return std::make_unique<msg_type>(msg_type{c}); }
+};
+
+BOOST_FIXTURE_TEST_CASE(test_enqueue, Fixture)
+{
+    auto q = utils::sharded_queue<msg_type>{2, 2, 1};
+    BOOST_TEST(q.enqueue(0, make_msg('1')));
+    BOOST_TEST(q.enqueue(0, make_msg('2')));
+    BOOST_TEST(!q.enqueue(0, make_msg('3')));
+    BOOST_TEST(q.enqueue(1, make_msg('3')));
+    BOOST_CHECK_EQUAL(q.size(), 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_dequeue, Fixture)
+{
+    auto q = utils::sharded_queue<msg_type>{1, 3, 1};
+    for (auto c : {'5', '6', '7'})
+    {
+        BOOST_TEST_REQUIRE(q.enqueue(0, make_msg(c)));
+    }
+    for (auto c : {'5', '6', '7'})
+    {
+        auto msg = q.dequeue(0);
+        BOOST_TEST_REQUIRE(msg);
+        BOOST_CHECK_EQUAL((*msg)[0], c);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_steal, Fixture)
+{
+    // lane 0 belongs to worker 0, worker 1 helps out
+    auto q = utils::sharded_queue<msg_type>{2, 2, 2};
+    BOOST_CHECK_EQUAL(q.owner(0), 0);
+    BOOST_CHECK_EQUAL(q.owner(1), 1);
+
+    BOOST_TEST_REQUIRE(q.enqueue(0, make_msg('a')));
+    auto msg = q.dequeue(1);
+    BOOST_TEST_REQUIRE(msg);
+    BOOST_CHECK_EQUAL((*msg)[0], 'a');
+    BOOST_CHECK_EQUAL(q.owner(0), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_rebalance, Fixture)
+{
+    auto q = utils::sharded_queue<msg_type>{2, 2, 2, wait_strategy{}, std::chrono::milliseconds{1}};
+    BOOST_TEST_REQUIRE(q.enqueue(0, make_msg('a')));
+    BOOST_TEST_REQUIRE(q.enqueue(0, make_msg('b')));
+
+    // worker 0 takes a message and does not come back
+    BOOST_TEST_REQUIRE(q.dequeue(0));
+    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+
+    auto msg = q.dequeue(1);
+    BOOST_TEST_REQUIRE(msg);
+    BOOST_CHECK_EQUAL((*msg)[0], 'b');
+    BOOST_CHECK_EQUAL(q.owner(0), 1);
+
+    // worker 0 returns and gets its lane back
+    BOOST_TEST_REQUIRE(q.enqueue(0, make_msg('c')));
+    BOOST_TEST_REQUIRE(q.dequeue(0));
+    BOOST_CHECK_EQUAL(q.owner(0), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_wait_policies, Fixture)
+{
+    for (auto policy : {wait_policy::block, wait_policy::spin, wait_policy::spin_yield, wait_policy::spin_park})
+    {
+        auto q = utils::sharded_queue<msg_type>{1, 1, 1, wait_strategy{policy, std::chrono::microseconds{10}}};
+
+        auto producer = std::thread{[this, &q]()
+                                    {
+                                        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+                                        BOOST_TEST(q.enqueue(0, make_msg('x')));
+                                    }};
+        auto msg = q.dequeue(0);
+        producer.join();
+        BOOST_TEST_REQUIRE(msg, "policy " << to_string(policy));
+        BOOST_CHECK_EQUAL((*msg)[0], 'x');
+
+        q.abort_queue();
+        BOOST_TEST(!q.dequeue(0), "policy " << to_string(policy));
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_abort, Fixture)
+{
+    auto q      = utils::sharded_queue<msg_type>{1, 1, 2};
+    auto waiter = std::thread{[&q]() { BOOST_TEST(!q.dequeue(1)); }};
+    q.abort_queue();
+    waiter.join();
+    BOOST_TEST(!q.dequeue(0));
+
+    // a worker that keeps calling dequeue after the abort must not starve the others
+    auto aborted = utils::sharded_queue<msg_type>{1, 1, 2};
+    auto parked  = std::thread{[&aborted]() { BOOST_TEST(!aborted.dequeue(0)); }};
+    aborted.abort_queue();
+    for (auto i = 0; i < 10; ++i)
+    {
+        BOOST_TEST(!aborted.dequeue(1));
+    }
+    parked.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace utils
@@ -0,0 +1,62 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "utils/spsc_ring.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <thread>
+
+namespace utils
+{
+
+BOOST_AUTO_TEST_SUITE(suite_spsc_ring)
+
+BOOST_AUTO_TEST_CASE(test_push_pop)
+{
+    auto ring  = utils::spsc_ring<int>{2};
+    auto value = 0;
+    BOOST_TEST(!ring.pop(value));
+    BOOST_TEST(ring.push(1));
+    BOOST_TEST(ring.push(2));
+    BOOST_TEST(!ring.push(3));
+    BOOST_CHECK_EQUAL(ring.size(), 2);
+
+    BOOST_TEST_REQUIRE(ring.pop(value));
+    BOOST_CHECK_EQUAL(value, 1);
+    BOOST_TEST(ring.push(3));
+    for (auto expected : {2, 3})
+    {
+        BOOST_TEST_REQUIRE(ring.pop(value));
+        BOOST_CHECK_EQUAL(value, expected);
+    }
+    BOOST_CHECK_EQUAL(ring.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent_order)
+{
+    constexpr auto count = 100000;
+
+    auto ring     = utils::spsc_ring<int>{8};
+    auto producer = std::thread{[&ring]()
+                                {
+                                    for (auto i = 0; i < count; ++i)
+                                    {
+                                        while (!ring.push(int{i})) std::this_thread::yield();
+                                    }
+                                }};
+
+    auto value = 0;
+    for (auto i = 0; i < count; ++i)
+    {
+        while (!ring.pop(value)) std::this_thread::yield();
+        BOOST_REQUIRE_EQUAL(value, i);
+    }
+    producer.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace utils
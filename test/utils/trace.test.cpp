@@ -0,0 +1,95 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "utils/trace.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <thread>
+
+namespace utils
+{
+
+BOOST_AUTO_TEST_SUITE(suite_trace)
+
+struct Fixture
+{
+    Fixture() { trace::clear(); }
+    ~Fixture() { trace::set_sampling(0); }
+};
+
+BOOST_FIXTURE_TEST_CASE(test_disabled, Fixture)
+{
+    trace::set_sampling(0);
+    {
+        auto t = trace::scope{"stage", 1};
+    }
+    auto os = std::ostringstream{};
+    BOOST_CHECK_EQUAL(trace::dump(os), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sampling, Fixture)
+{
+    trace::set_sampling(2);
+    auto traced = std::uint64_t{0};
+    auto frames = size_t{0};
+    for (std::uint64_t id = 1; id <= 8; ++id)
+    {
+        auto t = trace::scope{"outer", id};
+        auto n = trace::scope{"inner"};
+        if (trace::sampled(id))
+        {
+            traced = id;
+            frames++;
+        }
+    }
+    BOOST_TEST_REQUIRE(frames > 0);
+    BOOST_TEST(frames < 8);
+
+    auto os = std::ostringstream{};
+    BOOST_CHECK_EQUAL(trace::dump(os), 2 * frames);  // outer and inner of the sampled frames
+
+    auto json = os.str();
+    BOOST_TEST(json.starts_with("{\"traceEvents\":["));
+    BOOST_TEST(json.find(R"("name":"inner")") != std::string::npos);
+    BOOST_TEST(json.find(R"("args":{"frame":)" + std::to_string(traced) + "}") != std::string::npos);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_sampling_lanes, Fixture)
+{
+    // the frame ids of a lane are lane + lanes * sequence, every lane gets its share
+    constexpr std::uint64_t lanes = 4;
+    trace::set_sampling(2);
+    for (std::uint64_t lane = 0; lane < lanes; ++lane)
+    {
+        auto cnt = 0;
+        for (std::uint64_t seq = 1; seq <= 1000; ++seq)
+        {
+            cnt += trace::sampled(lane + lanes * seq) ? 1 : 0;
+        }
+        BOOST_TEST(cnt > 400, "lane " << lane);
+        BOOST_TEST(cnt < 600, "lane " << lane);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_threads, Fixture)
+{
+    trace::set_sampling(1);
+    auto worker = std::thread{[]()
+                              {
+                                  trace::set_thread_name("worker \"1\"");
+                                  trace::record("stage", 7, trace::clock::now());
+                              }};
+    worker.join();
+
+    auto os = std::ostringstream{};
+    BOOST_CHECK_EQUAL(trace::dump(os), 1);
+    BOOST_TEST(os.str().find(R"("args":{"name":"worker \"1\""})") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace utils
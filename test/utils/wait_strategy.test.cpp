@@ -0,0 +1,60 @@
+/**
+ * Copyright Claus Beckenbauer 2004 - 2022.
+ * Distributed under the Boost Software License, Version 1.0.
+ * (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "utils/wait_strategy.hpp"
+
+#include <algorithm>
+#include <array>
+#include <boost/test/unit_test.hpp>
+
+namespace utils
+{
+
+BOOST_AUTO_TEST_SUITE(suite_wait_strategy)
+
+BOOST_AUTO_TEST_CASE(test_parse)
+{
+    for (auto policy : {wait_policy::block, wait_policy::spin, wait_policy::spin_yield, wait_policy::spin_park})
+    {
+        BOOST_TEST((parse_wait_policy(to_string(policy)) == policy));
+    }
+    BOOST_CHECK_THROW(parse_wait_policy("sleep"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_backoff)
+{
+    // the pauses double with every call up to the limit
+    auto b        = backoff{};
+    auto expected = 1U;
+    for (auto i = 0; i < 10; ++i)
+    {
+        BOOST_CHECK_EQUAL(b.length(), expected);
+        b.pause();
+        expected = std::min(2 * expected, backoff::max_pauses);
+    }
+    BOOST_CHECK_EQUAL(b.length(), backoff::max_pauses);
+}
+
+BOOST_AUTO_TEST_CASE(test_escalation)
+{
+    using namespace std::chrono_literals;
+    constexpr auto budget = std::chrono::nanoseconds{50us};
+
+    auto steps = [budget](wait_policy p)
+    {
+        auto w = wait_strategy{p, budget};
+        return std::array{next_step(w, 0ns), next_step(w, budget - 1ns), next_step(w, budget), next_step(w, 1s)};
+    };
+    using enum wait_step;
+    BOOST_TEST((steps(wait_policy::block) == std::array{park, park, park, park}));
+    BOOST_TEST((steps(wait_policy::spin) == std::array{spin, spin, spin, spin}));
+    BOOST_TEST((steps(wait_policy::spin_yield) == std::array{spin, spin, yield, yield}));
+    BOOST_TEST((steps(wait_policy::spin_park) == std::array{spin, spin, park, park}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace utils